@@ -0,0 +1,54 @@
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace {
+
+    // Simulates a request handler that builds a short-lived map, probes it
+    // and throws it away.
+    template <class Map>
+    int64_t handle_request(Map& map, int64_t entries)
+    {
+        for (int64_t i = 0; i < entries; ++i) {
+            map.insert((i * 7919) % entries, i);
+        }
+
+        int64_t sum = 0;
+        for (int64_t i = 0; i < entries; i += 3) {
+            sum += map.at(i);
+        }
+        return sum;
+    }
+
+    void BM_RequestDefaultHeap(benchmark::State& state)
+    {
+        const int64_t entries = state.range(0);
+        for (auto _ : state) {
+            fox::FlatMap<int64_t, int64_t> map;
+            benchmark::DoNotOptimize(handle_request(map, entries));
+        }
+        state.SetItemsProcessed(state.iterations() * entries);
+    }
+
+    void BM_RequestMonotonicArena(benchmark::State& state)
+    {
+        const int64_t entries = state.range(0);
+        std::array<std::byte, 1 << 20> buffer{};
+        for (auto _ : state) {
+            std::pmr::monotonic_buffer_resource arena(
+                    buffer.data(), buffer.size());
+            fox::pmr::FlatMap<int64_t, int64_t> map(&arena);
+            benchmark::DoNotOptimize(handle_request(map, entries));
+        }
+        state.SetItemsProcessed(state.iterations() * entries);
+    }
+
+} // namespace
+
+BENCHMARK(BM_RequestDefaultHeap)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK(BM_RequestMonotonicArena)->RangeMultiplier(4)->Range(4, 4096);
@@ -0,0 +1,76 @@
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+    using Map = fox::FlatMap<uint64_t, uint64_t>;
+
+    // Lookups per request, as in a handler resolving many keys at once.
+    constexpr size_t batchSize = 256;
+
+    Map make_map(size_t count)
+    {
+        Map map(count);
+        for (size_t i = 0; i < count; ++i) {
+            map.insert(i * 2, i);
+        }
+        return map;
+    }
+
+    std::vector<uint64_t> make_probes(size_t count)
+    {
+        std::mt19937_64 engine(42);
+        std::uniform_int_distribution<uint64_t> dist(0, count * 2);
+        std::vector<uint64_t> probes(1 << 16);
+        for (auto& probe : probes) {
+            probe = dist(engine);
+        }
+        return probes;
+    }
+
+    void BM_FindLoop(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        const Map map = make_map(count);
+        const auto probes = make_probes(count);
+        std::vector<Map::iterator> found(batchSize, map.end());
+
+        size_t next = 0;
+        for (auto _ : state) {
+            for (size_t i = 0; i < batchSize; ++i) {
+                found[i] = map.find(probes[next + i]);
+            }
+            benchmark::DoNotOptimize(found.data());
+            next = (next + batchSize) % probes.size();
+        }
+        state.SetItemsProcessed(
+                state.iterations() * static_cast<int64_t>(batchSize));
+    }
+
+    void BM_FindBatch(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        const Map map = make_map(count);
+        const auto probes = make_probes(count);
+        std::vector<Map::iterator> found(batchSize, map.end());
+
+        size_t next = 0;
+        for (auto _ : state) {
+            const auto* first = probes.data() + next;
+            map.find_batch(first, first + batchSize, found.begin());
+            benchmark::DoNotOptimize(found.data());
+            next = (next + batchSize) % probes.size();
+        }
+        state.SetItemsProcessed(
+                state.iterations() * static_cast<int64_t>(batchSize));
+    }
+
+} // namespace
+
+BENCHMARK(BM_FindLoop)->Arg(1 << 12)->Arg(1 << 20)->Arg(1 << 25);
+BENCHMARK(BM_FindBatch)->Arg(1 << 12)->Arg(1 << 20)->Arg(1 << 25);
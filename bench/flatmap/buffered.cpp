@@ -0,0 +1,93 @@
+#include <buffered_flatmap.hpp>
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Flat = fox::FlatMap<uint64_t, uint64_t>;
+    using Buffered = fox::BufferedFlatMap<uint64_t, uint64_t>;
+
+    std::vector<uint64_t> make_keys(size_t count, uint32_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys(count);
+        for (auto& key : keys) {
+            key = rng();
+        }
+        return keys;
+    }
+
+    // Bulk construction; inserting a million random keys one by one
+    // would dominate the setup.
+    Flat make_map(const std::vector<uint64_t>& keys)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        pairs.reserve(keys.size());
+        for (const auto key : keys) {
+            pairs.emplace_back(key, key);
+        }
+        return Flat(pairs.begin(), pairs.end());
+    }
+
+    // Inserts a burst of random keys into a map that already holds
+    // state.range(0) keys, then reads one key so the buffered map has to
+    // answer from both the delta and the main array.
+    template <class Map>
+    void BM_InsertBurst(benchmark::State& state)
+    {
+        const auto base = make_keys(static_cast<size_t>(state.range(0)), 1);
+        const auto burst = make_keys(static_cast<size_t>(state.range(1)), 2);
+        const Flat initial = make_map(base);
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            Map map(initial);
+            state.ResumeTiming();
+            for (const auto key : burst) {
+                map.insert(key, key);
+            }
+            benchmark::DoNotOptimize(map.contains(burst.front()));
+        }
+        state.SetItemsProcessed(
+                static_cast<int64_t>(state.iterations()) * state.range(1));
+    }
+
+    // Lookups with a half-full delta, against the same plain map.
+    template <class Map>
+    void BM_LookupPending(benchmark::State& state)
+    {
+        const auto keys = make_keys(static_cast<size_t>(state.range(0)), 1);
+        Map map(make_map(keys));
+        const auto extra = make_keys(512, 3);
+        for (const auto key : extra) {
+            map.insert(key, key);
+        }
+
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.contains(keys[next]));
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+    }
+
+    void burst_args(benchmark::internal::Benchmark* bench)
+    {
+        for (const int64_t size : {1 << 14, 1 << 18}) {
+            for (const int64_t burst : {1 << 10, 1 << 14}) {
+                bench->Args({size, burst});
+            }
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_InsertBurst, Flat)->Apply(burst_args);
+BENCHMARK_TEMPLATE(BM_InsertBurst, Buffered)->Apply(burst_args);
+BENCHMARK_TEMPLATE(BM_LookupPending, Flat)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_LookupPending, Buffered)->Range(1 << 10, 1 << 20);
@@ -0,0 +1,145 @@
+#include <concurrent_flatmap.hpp>
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Map = fox::FlatMap<uint32_t, uint32_t>;
+
+    constexpr size_t mapSize = 100000;
+
+    // Read-side baseline: the same FlatMap behind a reader-writer lock.
+    struct SharedMutexMap {
+        mutable std::shared_mutex mutex;
+        Map map;
+    };
+
+    Map make_map()
+    {
+        Map map(mapSize);
+        for (size_t i = 0; i < mapSize; ++i) {
+            map.insert(static_cast<uint32_t>(i * 2), static_cast<uint32_t>(i));
+        }
+        return map;
+    }
+
+    std::vector<uint32_t> make_probes(int seed)
+    {
+        std::mt19937 engine(static_cast<uint32_t>(seed));
+        std::uniform_int_distribution<uint32_t> dist(
+                0, static_cast<uint32_t>(mapSize * 2));
+        std::vector<uint32_t> probes(1 << 16);
+        for (auto& probe : probes) {
+            probe = dist(engine);
+        }
+        return probes;
+    }
+
+    // A single writer refreshes one entry per millisecond while the
+    // benchmark threads read, like a routing table being updated.
+    class Refresher {
+    public:
+        template <typename Refresh>
+        explicit Refresher(Refresh refresh)
+            : thread_([this, refresh] {
+                  for (uint32_t round = 0; !done_.load(); ++round) {
+                      refresh(round);
+                      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                  }
+              })
+        {
+        }
+
+        ~Refresher()
+        {
+            done_ = true;
+            thread_.join();
+        }
+
+    private:
+        std::atomic<bool> done_{false};
+        std::thread thread_;
+    };
+
+    std::unique_ptr<fox::ConcurrentFlatMap<uint32_t, uint32_t>> rcuMap;
+    std::unique_ptr<SharedMutexMap> lockedMap;
+    std::unique_ptr<Refresher> refresher;
+
+    void setup_rcu(const benchmark::State&)
+    {
+        rcuMap = std::make_unique<fox::ConcurrentFlatMap<uint32_t, uint32_t>>(
+                make_map());
+        refresher = std::make_unique<Refresher>([](uint32_t round) {
+            rcuMap->update([round](auto& map) {
+                map.insert_or_assign(round % mapSize * 2, round);
+            });
+        });
+    }
+
+    void setup_shared_mutex(const benchmark::State&)
+    {
+        lockedMap = std::make_unique<SharedMutexMap>();
+        lockedMap->map = make_map();
+        refresher = std::make_unique<Refresher>([](uint32_t round) {
+            std::unique_lock<std::shared_mutex> lock(lockedMap->mutex);
+            lockedMap->map.insert_or_assign(round % mapSize * 2, round);
+        });
+    }
+
+    void teardown(const benchmark::State&)
+    {
+        refresher.reset();
+        rcuMap.reset();
+        lockedMap.reset();
+    }
+
+    void BM_RcuFind(benchmark::State& state)
+    {
+        const auto probes = make_probes(state.thread_index());
+        const auto reader = rcuMap->reader();
+
+        size_t next = 0;
+        for (auto _ : state) {
+            const auto snapshot = reader.pin();
+            benchmark::DoNotOptimize(snapshot->find(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_SharedMutexFind(benchmark::State& state)
+    {
+        const auto probes = make_probes(state.thread_index());
+
+        size_t next = 0;
+        for (auto _ : state) {
+            std::shared_lock<std::shared_mutex> lock(lockedMap->mutex);
+            benchmark::DoNotOptimize(lockedMap->map.find(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+} // namespace
+
+BENCHMARK(BM_RcuFind)
+        ->Setup(setup_rcu)
+        ->Teardown(teardown)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
+BENCHMARK(BM_SharedMutexFind)
+        ->Setup(setup_shared_mutex)
+        ->Teardown(teardown)
+        ->ThreadRange(1, 64)
+        ->UseRealTime();
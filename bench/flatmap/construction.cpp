@@ -0,0 +1,67 @@
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <map>
+
+namespace {
+
+    std::vector<std::pair<int64_t, int64_t>> make_items(size_t count)
+    {
+        std::vector<std::pair<int64_t, int64_t>> items;
+        items.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const auto key = static_cast<int64_t>(i);
+            items.emplace_back(key, key);
+        }
+
+        std::mt19937_64 engine(42);
+        std::shuffle(items.begin(), items.end(), engine);
+        return items;
+    }
+
+    void BM_FlatMapConstruct(benchmark::State& state)
+    {
+        const auto items = make_items(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            fox::FlatMap<int64_t, int64_t> map(items.begin(), items.end());
+            benchmark::DoNotOptimize(map);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_FlatMapConstructSortedUnique(benchmark::State& state)
+    {
+        auto items = make_items(static_cast<size_t>(state.range(0)));
+        std::sort(items.begin(), items.end());
+        for (auto _ : state) {
+            fox::FlatMap<int64_t, int64_t> map(
+                    fox::sorted_unique, items.begin(), items.end());
+            benchmark::DoNotOptimize(map);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_StdMapConstruct(benchmark::State& state)
+    {
+        const auto items = make_items(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            std::map<int64_t, int64_t> map(items.begin(), items.end());
+            benchmark::DoNotOptimize(map);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+} // namespace
+
+BENCHMARK(BM_FlatMapConstruct)->RangeMultiplier(8)->Range(1 << 10, 1 << 21);
+BENCHMARK(BM_FlatMapConstructSortedUnique)
+        ->RangeMultiplier(8)
+        ->Range(1 << 10, 1 << 21);
+BENCHMARK(BM_StdMapConstruct)->RangeMultiplier(8)->Range(1 << 10, 1 << 21);
@@ -0,0 +1,107 @@
+#include "counters.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    std::atomic<uint64_t> allocatedBytes{0};
+    std::atomic<uint64_t> allocationCount{0};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* data = std::malloc(size == 0 ? 1 : size)) {
+        return data;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, size_t /*size*/) noexcept
+{
+    std::free(data);
+}
+
+namespace fox::bench {
+
+    uint64_t allocated_bytes()
+    {
+        return allocatedBytes.load(std::memory_order_relaxed);
+    }
+
+    uint64_t allocation_count()
+    {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+#if defined(__linux__)
+    CacheMissCounter::CacheMissCounter()
+    {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        fd_ = static_cast<int>(
+                syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    CacheMissCounter::~CacheMissCounter()
+    {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    void CacheMissCounter::start()
+    {
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t CacheMissCounter::stop()
+    {
+        uint64_t count = 0;
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+#else
+    CacheMissCounter::CacheMissCounter() = default;
+    CacheMissCounter::~CacheMissCounter() = default;
+
+    void CacheMissCounter::start()
+    {
+    }
+
+    uint64_t CacheMissCounter::stop()
+    {
+        return 0;
+    }
+#endif
+}; // namespace fox::bench
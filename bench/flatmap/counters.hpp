@@ -0,0 +1,75 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fox::bench {
+
+    // Bytes requested from the global operator new since program start.
+    // The replacement operators live in counters.cpp.
+    uint64_t allocated_bytes();
+
+    // Calls to the global operator new since program start.
+    uint64_t allocation_count();
+
+    // Hardware cache-miss counter for the calling thread, read through
+    // perf_event_open on Linux. valid() is false when the kernel refuses
+    // access (e.g. perf_event_paranoid) or on other platforms.
+    class CacheMissCounter {
+    public:
+        CacheMissCounter();
+        ~CacheMissCounter();
+
+        CacheMissCounter(const CacheMissCounter&) = delete;
+        CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+        bool valid() const
+        {
+            return fd_ >= 0;
+        }
+
+        void start();
+        uint64_t stop();
+
+    private:
+        int fd_ = -1;
+    };
+
+    // Measures allocations and cache misses across a benchmark loop and
+    // reports them per iteration.
+    class OpCounters {
+    public:
+        void start()
+        {
+            bytes_ = allocated_bytes();
+            allocations_ = allocation_count();
+            misses_.start();
+        }
+
+        void stop(benchmark::State& state)
+        {
+            const uint64_t misses = misses_.stop();
+            const uint64_t bytes = allocated_bytes() - bytes_;
+            const uint64_t allocations = allocation_count() - allocations_;
+
+            state.counters["bytes_allocated/op"] = benchmark::Counter(
+                    static_cast<double>(bytes),
+                    benchmark::Counter::kAvgIterations);
+            state.counters["allocations/op"] = benchmark::Counter(
+                    static_cast<double>(allocations),
+                    benchmark::Counter::kAvgIterations);
+            if (misses_.valid()) {
+                state.counters["cache_misses/op"] = benchmark::Counter(
+                        static_cast<double>(misses),
+                        benchmark::Counter::kAvgIterations);
+            }
+        }
+
+    private:
+        CacheMissCounter misses_;
+        uint64_t bytes_ = 0;
+        uint64_t allocations_ = 0;
+    };
+}; // namespace fox::bench
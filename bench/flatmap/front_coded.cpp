@@ -0,0 +1,129 @@
+#include "counters.hpp"
+
+#include <flatmap.hpp>
+#include <front_coded_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // Sorted, unique URL-like keys: a few hosts, nested paths and query
+    // strings, so neighbouring keys share long prefixes.
+    std::vector<std::pair<std::string, uint32_t>> make_urls(size_t count)
+    {
+        std::mt19937_64 rng(42);
+        std::vector<std::string> keys;
+        keys.reserve(count);
+        while (keys.size() < count) {
+            keys.push_back(
+                    "https://www.shop" + std::to_string(rng() % 16)
+                    + ".example.com/catalog/" + std::to_string(rng() % 64)
+                    + "/products/item-" + std::to_string(rng() % 1000000)
+                    + "?ref=campaign-" + std::to_string(rng() % 8));
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<std::pair<std::string, uint32_t>> pairs;
+        pairs.reserve(keys.size());
+        for (auto& key : keys) {
+            pairs.emplace_back(std::move(key), pairs.size());
+        }
+        return pairs;
+    }
+
+    std::vector<std::string> make_probes(
+            const std::vector<std::pair<std::string, uint32_t>>& pairs)
+    {
+        std::vector<std::string> probes;
+        probes.reserve(pairs.size());
+        for (const auto& pair : pairs) {
+            probes.push_back(pair.first);
+        }
+        std::shuffle(probes.begin(), probes.end(), std::mt19937_64(7));
+        return probes;
+    }
+
+    void BM_StringFlatMapFind(benchmark::State& state)
+    {
+        const auto pairs = make_urls(static_cast<size_t>(state.range(0)));
+        // The copy allocates the element array and every key too long
+        // for the small string buffer, which is the map's footprint.
+        const uint64_t before = fox::bench::allocated_bytes();
+        const fox::FlatMap<std::string, uint32_t> map(
+                fox::sorted_unique, pairs.begin(), pairs.end());
+        const uint64_t bytes = fox::bench::allocated_bytes() - before;
+
+        const auto probes = make_probes(pairs);
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(probes[next]));
+            next = next + 1 == probes.size() ? 0 : next + 1;
+        }
+        state.counters["bytes_per_key"] = static_cast<double>(bytes)
+                / static_cast<double>(map.size());
+    }
+
+    template <size_t BlockSize>
+    void BM_FrontCodedFind(benchmark::State& state)
+    {
+        const auto pairs = make_urls(static_cast<size_t>(state.range(0)));
+        const fox::FrontCodedFlatMap<uint32_t, BlockSize> map(
+                fox::sorted_unique, pairs.begin(), pairs.end());
+
+        const auto probes = make_probes(pairs);
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(probes[next]));
+            next = next + 1 == probes.size() ? 0 : next + 1;
+        }
+        state.counters["bytes_per_key"] = static_cast<double>(map.bytes())
+                / static_cast<double>(map.size());
+    }
+
+    void BM_StringFlatMapScan(benchmark::State& state)
+    {
+        const auto pairs = make_urls(static_cast<size_t>(state.range(0)));
+        const fox::FlatMap<std::string, uint32_t> map(
+                fox::sorted_unique, pairs.begin(), pairs.end());
+        for (auto _ : state) {
+            size_t sum = 0;
+            for (const auto& pair : map) {
+                sum += pair.first.size() + pair.second;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(
+                state.iterations() * static_cast<int64_t>(map.size()));
+    }
+
+    void BM_FrontCodedScan(benchmark::State& state)
+    {
+        const auto pairs = make_urls(static_cast<size_t>(state.range(0)));
+        const fox::FrontCodedFlatMap<uint32_t> map(
+                fox::sorted_unique, pairs.begin(), pairs.end());
+        for (auto _ : state) {
+            size_t sum = 0;
+            for (const auto& pair : map) {
+                sum += pair.first.size() + pair.second;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(
+                state.iterations() * static_cast<int64_t>(map.size()));
+    }
+} // namespace
+
+BENCHMARK(BM_StringFlatMapFind)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_FrontCodedFind, 16)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_FrontCodedFind, 32)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_FrontCodedFind, 64)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(BM_StringFlatMapScan)->Arg(1 << 20);
+BENCHMARK(BM_FrontCodedScan)->Arg(1 << 20);
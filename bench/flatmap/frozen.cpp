@@ -0,0 +1,57 @@
+#include <flatmap.hpp>
+#include <frozen_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    fox::FlatMap<uint32_t, uint32_t> make_map(size_t count)
+    {
+        fox::FlatMap<uint32_t, uint32_t> map(count);
+        for (size_t i = 0; i < count; ++i) {
+            map.insert(static_cast<uint32_t>(i * 2), static_cast<uint32_t>(i));
+        }
+        return map;
+    }
+
+    std::vector<uint32_t> make_probes(size_t count)
+    {
+        std::mt19937 engine(42);
+        std::uniform_int_distribution<uint32_t> dist(
+                0, static_cast<uint32_t>(count * 2));
+        std::vector<uint32_t> probes(1 << 16);
+        for (auto& probe : probes) {
+            probe = dist(engine);
+        }
+        return probes;
+    }
+
+    template <class Map>
+    void BM_Find(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        Map map(make_map(count));
+        const auto probes = make_probes(count);
+
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Find, fox::FlatMap<uint32_t, uint32_t>)
+        ->Arg(1000)
+        ->Arg(1000000)
+        ->Arg(100000000);
+BENCHMARK_TEMPLATE(BM_Find, fox::FrozenFlatMap<uint32_t, uint32_t>)
+        ->Arg(1000)
+        ->Arg(1000000)
+        ->Arg(100000000);
@@ -0,0 +1,86 @@
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Map = fox::FlatMap<uint64_t, uint64_t>;
+
+    enum Distribution { Uniform, Lognormal, Clustered };
+
+    std::vector<uint64_t> make_keys(Distribution distribution, size_t count)
+    {
+        std::mt19937_64 rng(42);
+        std::lognormal_distribution<double> lognormal(0, 2);
+        std::vector<uint64_t> keys;
+        keys.reserve(count);
+        while (keys.size() < count) {
+            switch (distribution) {
+            case Uniform:
+                keys.push_back(rng() >> 8U);
+                break;
+            case Lognormal:
+                keys.push_back(static_cast<uint64_t>(lognormal(rng) * 1e9));
+                break;
+            case Clustered:
+                // Dense runs of IDs at random offsets, like per-tenant
+                // sequences.
+                for (uint64_t base = rng() >> 8U, i = 0; i < 1000; ++i) {
+                    keys.push_back(base + i * (1 + rng() % 4));
+                }
+                break;
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+
+    // state.range(1) is the index's error bound, or 0 for plain binary
+    // search.
+    template <Distribution distribution>
+    void BM_LearnedFind(benchmark::State& state)
+    {
+        const auto keys = make_keys(
+                distribution, static_cast<size_t>(state.range(0)));
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        for (const auto key : keys) {
+            pairs.emplace_back(key, key);
+        }
+        Map map(fox::sorted_unique, pairs.begin(), pairs.end());
+        if (state.range(1) > 0) {
+            map.build_learned_index(static_cast<size_t>(state.range(1)));
+        }
+
+        auto probes = keys;
+        std::shuffle(probes.begin(), probes.end(), std::mt19937_64(7));
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(probes[next]));
+            next = next + 1 == probes.size() ? 0 : next + 1;
+        }
+        state.counters["index_bytes_per_key"] = static_cast<double>(
+                map.learned_index_bytes())
+                / static_cast<double>(map.size());
+    }
+
+    void learned_args(benchmark::internal::Benchmark* bench)
+    {
+        for (const int64_t size : {1 << 16, 1 << 20, 1 << 24}) {
+            for (const int64_t epsilon : {0, 8, 32, 128}) {
+                bench->Args({size, epsilon});
+            }
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_LearnedFind, Uniform)->Apply(learned_args);
+BENCHMARK_TEMPLATE(BM_LearnedFind, Lognormal)->Apply(learned_args);
+BENCHMARK_TEMPLATE(BM_LearnedFind, Clustered)->Apply(learned_args);
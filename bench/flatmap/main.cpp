@@ -0,0 +1,42 @@
+#include "suite.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+    constexpr const char* maxSizeFlag = "--flatmap_max_size=";
+
+} // namespace
+
+// Accepts --flatmap_max_size=N (default 10000) on top of the usual Google
+// Benchmark flags; use e.g. --benchmark_out=run.json
+// --benchmark_out_format=json to keep results for comparing commits.
+int main(int argc, char** argv)
+{
+    size_t maxSize = 10000;
+
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], maxSizeFlag, std::strlen(maxSizeFlag))
+            == 0) {
+            maxSize = std::stoull(argv[i] + std::strlen(maxSizeFlag));
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    fox::bench::register_suite(maxSize);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return EXIT_FAILURE;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+#include <flatmap.hpp>
+#include <packed_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Flat = fox::FlatMap<uint64_t, uint64_t>;
+    using Packed = fox::PackedFlatMap<uint64_t, uint64_t>;
+
+    // Even keys are loaded up front; writes insert odd keys, so they
+    // always add a new element.
+    template <class Map>
+    Map make_map(size_t count)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        pairs.reserve(count);
+        for (uint64_t key = 0; key < count; ++key) {
+            pairs.emplace_back(key * 2, key);
+        }
+        return Map(fox::sorted_unique, pairs.begin(), pairs.end());
+    }
+
+    // state.range(1) percent of the operations are reads, the rest random
+    // inserts, each paired with the erase of an earlier insert so the size
+    // stays put.
+    template <class Map>
+    void BM_Mixed(benchmark::State& state)
+    {
+        const auto count = static_cast<uint64_t>(state.range(0));
+        const auto readPercent = static_cast<uint64_t>(state.range(1));
+        Map map = make_map<Map>(count);
+
+        std::mt19937_64 rng(42);
+        std::vector<uint64_t> inserted;
+        size_t oldest = 0;
+        for (auto _ : state) {
+            const uint64_t key = rng() % (count * 2);
+            if (rng() % 100 < readPercent) {
+                benchmark::DoNotOptimize(map.find(key));
+                continue;
+            }
+            if (map.insert(key | 1, key).second) {
+                inserted.push_back(key | 1);
+            }
+            if (inserted.size() - oldest > 1024) {
+                map.erase(inserted[oldest++]);
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Map>
+    void BM_Scan(benchmark::State& state)
+    {
+        const Map map = make_map<Map>(static_cast<size_t>(state.range(0)));
+        for (auto _ : state) {
+            uint64_t sum = 0;
+            for (const auto& [key, value] : map) {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(
+                static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    void mixed_args(benchmark::internal::Benchmark* bench)
+    {
+        for (const int64_t size : {1 << 16, 1 << 20, 1 << 23}) {
+            for (const int64_t readPercent : {0, 50, 90, 99}) {
+                bench->Args({size, readPercent});
+            }
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Mixed, Flat)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Mixed, Packed)->Apply(mixed_args);
+BENCHMARK_TEMPLATE(BM_Scan, Flat)->Range(1 << 16, 1 << 23);
+BENCHMARK_TEMPLATE(BM_Scan, Packed)->Range(1 << 16, 1 << 23);
@@ -0,0 +1,88 @@
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Map = fox::FlatMap<std::string, uint32_t>;
+
+    enum KeySet { Uuids, Words, Urls };
+
+    std::string make_key(KeySet keySet, std::mt19937_64& rng)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+        std::string key;
+        switch (keySet) {
+        case Uuids:
+            // Random hex, as in request or object IDs.
+            for (int i = 0; i < 32; ++i) {
+                key.push_back(hex[rng() % 16]);
+            }
+            break;
+        case Words:
+            // Lower-case names of 4 to 24 letters, skewed towards the
+            // common leading letters.
+            for (size_t i = 0, length = 4 + rng() % 21; i < length; ++i) {
+                key.push_back(static_cast<char>(
+                        'a' + std::min<uint64_t>(rng() % 26, rng() % 26)));
+            }
+            break;
+        case Urls:
+            // Everything shares "https://", so the prefixes tie and the
+            // cache can only narrow the search down to each host.
+            key = "https://www.site" + std::to_string(rng() % 100)
+                    + ".com/page/" + std::to_string(rng() % 1000000);
+            break;
+        }
+        return key;
+    }
+
+    // state.range(1) builds the prefix cache when set.
+    template <KeySet keySet>
+    void BM_PrefixFind(benchmark::State& state)
+    {
+        std::mt19937_64 rng(42);
+        std::vector<std::pair<std::string, uint32_t>> pairs;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            pairs.emplace_back(make_key(keySet, rng), i);
+        }
+        Map map(pairs.begin(), pairs.end());
+        if (state.range(1) != 0) {
+            map.build_prefix_cache();
+        }
+
+        std::vector<std::string> probes;
+        for (const auto& pair : map) {
+            probes.push_back(pair.first);
+        }
+        std::shuffle(probes.begin(), probes.end(), rng);
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(probes[next]));
+            next = next + 1 == probes.size() ? 0 : next + 1;
+        }
+        state.counters["cache_bytes_per_key"] = static_cast<double>(
+                map.prefix_cache_bytes())
+                / static_cast<double>(map.size());
+    }
+
+    void prefix_args(benchmark::internal::Benchmark* bench)
+    {
+        for (const int64_t size : {1 << 16, 1 << 20}) {
+            for (const int64_t cached : {0, 1}) {
+                bench->Args({size, cached});
+            }
+        }
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_PrefixFind, Uuids)->Apply(prefix_args);
+BENCHMARK_TEMPLATE(BM_PrefixFind, Words)->Apply(prefix_args);
+BENCHMARK_TEMPLATE(BM_PrefixFind, Urls)->Apply(prefix_args);
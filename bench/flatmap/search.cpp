@@ -0,0 +1,82 @@
+#include <flatmap_search.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+    template <class Key>
+    struct SearchFixture {
+        std::vector<Key> keys;
+        std::vector<Key> probes;
+
+        explicit SearchFixture(size_t count) : keys(count), probes(4096)
+        {
+            for (size_t i = 0; i < count; ++i) {
+                keys[i] = static_cast<Key>(i * 2);
+            }
+
+            std::mt19937_64 engine(42);
+            std::uniform_int_distribution<uint64_t> dist(0, count * 2);
+            for (auto& probe : probes) {
+                probe = static_cast<Key>(dist(engine));
+            }
+        }
+    };
+
+    template <class Key>
+    void BM_StdLowerBound(benchmark::State& state)
+    {
+        const SearchFixture<Key> fixture(static_cast<size_t>(state.range(0)));
+        const auto& keys = fixture.keys;
+
+        size_t next = 0;
+        for (auto _ : state) {
+            const Key key = fixture.probes[next];
+            benchmark::DoNotOptimize(std::lower_bound(
+                    keys.begin(),
+                    keys.end(),
+                    key,
+                    [](const Key& lhs, const Key& rhs) { return lhs < rhs; }));
+            next = (next + 1) % fixture.probes.size();
+        }
+    }
+
+    template <class Key>
+    void BM_BranchlessLowerBound(benchmark::State& state)
+    {
+        const SearchFixture<Key> fixture(static_cast<size_t>(state.range(0)));
+        const auto& keys = fixture.keys;
+
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fox::detail::lower_bound_index(
+                    keys.data(), keys.size(), fixture.probes[next]));
+            next = (next + 1) % fixture.probes.size();
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_StdLowerBound, uint32_t)
+        ->RangeMultiplier(16)
+        ->Range(1 << 6, 1 << 22);
+BENCHMARK_TEMPLATE(BM_BranchlessLowerBound, uint32_t)
+        ->RangeMultiplier(16)
+        ->Range(1 << 6, 1 << 22);
+BENCHMARK_TEMPLATE(BM_StdLowerBound, uint64_t)
+        ->RangeMultiplier(16)
+        ->Range(1 << 6, 1 << 22);
+BENCHMARK_TEMPLATE(BM_BranchlessLowerBound, uint64_t)
+        ->RangeMultiplier(16)
+        ->Range(1 << 6, 1 << 22);
+BENCHMARK_TEMPLATE(BM_StdLowerBound, double)
+        ->RangeMultiplier(16)
+        ->Range(1 << 6, 1 << 22);
+BENCHMARK_TEMPLATE(BM_BranchlessLowerBound, double)
+        ->RangeMultiplier(16)
+        ->Range(1 << 6, 1 << 22);
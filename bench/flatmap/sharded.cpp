@@ -0,0 +1,107 @@
+#include <flatmap.hpp>
+#include <sharded_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace {
+
+    constexpr size_t prefillSize = 100000;
+    constexpr size_t shardCount = 64;
+
+    // Write-side baseline: one FlatMap behind one lock.
+    struct LockedMap {
+        std::mutex mutex;
+        fox::FlatMap<uint64_t, uint64_t> map;
+
+        void insert(uint64_t key, uint64_t value)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            map.insert(key, value);
+        }
+    };
+
+    std::vector<uint64_t> make_keys(size_t count, uint64_t seed)
+    {
+        std::mt19937_64 engine(seed);
+        std::vector<uint64_t> keys(count);
+        for (auto& key : keys) {
+            key = engine();
+        }
+        return keys;
+    }
+
+    std::unique_ptr<fox::ShardedFlatMap<uint64_t, uint64_t>> shardedMap;
+    std::unique_ptr<LockedMap> lockedMap;
+
+    void setup_sharded(const benchmark::State&)
+    {
+        const auto keys = make_keys(prefillSize, 0);
+        shardedMap =
+                std::make_unique<fox::ShardedFlatMap<uint64_t, uint64_t>>(
+                        shardCount, keys.begin(), keys.end());
+        for (const auto key : keys) {
+            shardedMap->insert(key, key);
+        }
+    }
+
+    void setup_locked(const benchmark::State&)
+    {
+        const auto keys = make_keys(prefillSize, 0);
+        lockedMap = std::make_unique<LockedMap>();
+        for (const auto key : keys) {
+            lockedMap->map.insert(key, key);
+        }
+    }
+
+    void teardown(const benchmark::State&)
+    {
+        shardedMap.reset();
+        lockedMap.reset();
+    }
+
+    // Each thread inserts its own stream of random keys.
+    template <class Map>
+    void insert(benchmark::State& state, Map& map)
+    {
+        const auto keys = make_keys(
+                static_cast<size_t>(state.max_iterations),
+                static_cast<uint64_t>(state.thread_index()) + 1);
+
+        size_t next = 0;
+        for (auto _ : state) {
+            map.insert(keys[next], next);
+            ++next;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_ShardedInsert(benchmark::State& state)
+    {
+        insert(state, *shardedMap);
+    }
+
+    void BM_LockedInsert(benchmark::State& state)
+    {
+        insert(state, *lockedMap);
+    }
+
+} // namespace
+
+BENCHMARK(BM_ShardedInsert)
+        ->Setup(setup_sharded)
+        ->Teardown(teardown)
+        ->ThreadRange(1, 64)
+        ->Iterations(2000)
+        ->UseRealTime();
+BENCHMARK(BM_LockedInsert)
+        ->Setup(setup_locked)
+        ->Teardown(teardown)
+        ->ThreadRange(1, 64)
+        ->Iterations(2000)
+        ->UseRealTime();
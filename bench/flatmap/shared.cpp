@@ -0,0 +1,81 @@
+#include "counters.hpp"
+
+#include <flatmap.hpp>
+#include <shared_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // A configuration map of `count` settings with string names and
+    // values, as copied into every request context.
+    std::vector<std::pair<std::string, std::string>> make_config(
+            int64_t count)
+    {
+        std::vector<std::pair<std::string, std::string>> settings;
+        for (int64_t i = 0; i < count; ++i) {
+            settings.emplace_back(
+                    "service.option." + std::to_string(i),
+                    "value-of-setting-" + std::to_string(i));
+        }
+        return settings;
+    }
+
+    // Each iteration is one request: copy the configuration, read a few
+    // settings and drop the copy.
+    template <class Map>
+    void BM_RequestCopy(benchmark::State& state)
+    {
+        const auto settings = make_config(state.range(0));
+        const Map config(settings.begin(), settings.end());
+        const std::string names[] = {
+                settings.front().first,
+                settings[settings.size() / 2].first,
+                settings.back().first};
+
+        fox::bench::OpCounters counters;
+        counters.start();
+        for (auto _ : state) {
+            const Map context = config;
+            for (const auto& name : names) {
+                benchmark::DoNotOptimize(context.find(name));
+            }
+        }
+        counters.stop(state);
+    }
+
+    // As above, but one request in `state.range(1)` overrides a setting
+    // in its copy.
+    template <class Map>
+    void BM_RequestCopyWrite(benchmark::State& state)
+    {
+        const auto settings = make_config(state.range(0));
+        const Map config(settings.begin(), settings.end());
+        const std::string& name = settings.front().first;
+
+        fox::bench::OpCounters counters;
+        counters.start();
+        int64_t request = 0;
+        for (auto _ : state) {
+            Map context = config;
+            if (++request % state.range(1) == 0) {
+                context[name] = "override";
+            }
+            benchmark::DoNotOptimize(context.find(name));
+        }
+        counters.stop(state);
+    }
+
+    using Flat = fox::FlatMap<std::string, std::string>;
+    using Shared = fox::SharedFlatMap<std::string, std::string>;
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_RequestCopy, Flat)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_RequestCopy, Shared)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_RequestCopyWrite, Flat)->Args({256, 100});
+BENCHMARK_TEMPLATE(BM_RequestCopyWrite, Shared)->Args({256, 100});
@@ -0,0 +1,67 @@
+#include "counters.hpp"
+
+#include <flatmap.hpp>
+#include <small_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+    using Flat = fox::FlatMap<uint32_t, uint32_t>;
+    using Small = fox::SmallFlatMap<uint32_t, uint32_t, 8>;
+
+    std::vector<uint32_t> make_keys(size_t count)
+    {
+        std::vector<uint32_t> keys(count);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+        return keys;
+    }
+
+    // Builds a map of the given size per iteration, as a request handler
+    // filling a fresh header map would.
+    template <class Map>
+    void BM_Build(benchmark::State& state)
+    {
+        const auto keys = make_keys(static_cast<size_t>(state.range(0)));
+
+        fox::bench::OpCounters counters;
+        counters.start();
+        for (auto _ : state) {
+            Map map;
+            for (const auto key : keys) {
+                map.insert(key, key);
+            }
+            benchmark::DoNotOptimize(map);
+        }
+        counters.stop(state);
+    }
+
+    template <class Map>
+    void BM_Lookup(benchmark::State& state)
+    {
+        const auto keys = make_keys(static_cast<size_t>(state.range(0)));
+        Map map;
+        for (const auto key : keys) {
+            map.insert(key, key);
+        }
+
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.find(keys[next]));
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Build, Flat)->RangeMultiplier(2)->Range(1, 32);
+BENCHMARK_TEMPLATE(BM_Build, Small)->RangeMultiplier(2)->Range(1, 32);
+BENCHMARK_TEMPLATE(BM_Lookup, Flat)->RangeMultiplier(2)->Range(1, 32);
+BENCHMARK_TEMPLATE(BM_Lookup, Small)->RangeMultiplier(2)->Range(1, 32);
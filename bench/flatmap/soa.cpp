@@ -0,0 +1,59 @@
+#include <flatmap.hpp>
+#include <flatmap_soa.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Payload = std::array<char, 200>;
+
+    std::vector<std::pair<int64_t, Payload>> make_items(size_t count)
+    {
+        std::vector<std::pair<int64_t, Payload>> items(count);
+        for (size_t i = 0; i < count; ++i) {
+            items[i].first = static_cast<int64_t>(i) * 2;
+        }
+        return items;
+    }
+
+    std::vector<int64_t> make_probes(size_t count)
+    {
+        std::mt19937_64 engine(42);
+        std::uniform_int_distribution<int64_t> dist(
+                0, static_cast<int64_t>(count) * 2);
+        std::vector<int64_t> probes(1024);
+        for (auto& probe : probes) {
+            probe = dist(engine);
+        }
+        return probes;
+    }
+
+    template <class Map>
+    void BM_FindLargeValue(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        const auto items = make_items(count);
+        Map map(fox::sorted_unique, items.begin(), items.end());
+        const auto probes = make_probes(count);
+
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(map.contains(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+    }
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_FindLargeValue, fox::FlatMap<int64_t, Payload>)
+        ->RangeMultiplier(16)
+        ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindLargeValue, fox::FlatMapSoA<int64_t, Payload>)
+        ->RangeMultiplier(16)
+        ->Range(1 << 10, 1 << 20);
@@ -0,0 +1,102 @@
+#include <flatmap.hpp>
+#include <static_flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string_view>
+
+namespace {
+
+    constexpr std::pair<std::string_view, int> keywordList[] = {
+            {"alignas", 0}, {"auto", 1}, {"break", 2}, {"case", 3},
+            {"catch", 4}, {"class", 5}, {"const", 6}, {"continue", 7},
+            {"default", 8}, {"delete", 9}, {"do", 10}, {"else", 11},
+            {"enum", 12}, {"explicit", 13}, {"for", 14}, {"friend", 15},
+            {"goto", 16}, {"if", 17}, {"inline", 18}, {"namespace", 19},
+            {"new", 20}, {"operator", 21}, {"private", 22}, {"public", 23},
+            {"return", 24}, {"sizeof", 25}, {"static", 26}, {"struct", 27},
+            {"switch", 28}, {"template", 29}, {"using", 30}, {"while", 31}};
+
+    // Sorted at compile time from the same list.
+    constexpr auto staticKeywords = fox::make_static_flat_map(keywordList);
+
+    // Identifiers as a tokenizer sees them: keywords and other names.
+    constexpr std::array<std::string_view, 8> probes = {
+            "return", "value", "if", "size", "while", "i", "static", "node"};
+
+    void BM_KeywordFlatMap(benchmark::State& state)
+    {
+        const fox::FlatMap<std::string_view, int> keywords(
+                std::begin(keywordList), std::end(keywordList));
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(keywords.find(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+    }
+
+    void BM_KeywordStaticFlatMap(benchmark::State& state)
+    {
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(staticKeywords.find(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+    }
+
+    // What a FlatMap global pays at static initialization.
+    void BM_KeywordFlatMapBuild(benchmark::State& state)
+    {
+        for (auto _ : state) {
+            fox::FlatMap<std::string_view, int> keywords(
+                    std::begin(keywordList), std::end(keywordList));
+            benchmark::DoNotOptimize(keywords);
+        }
+    }
+
+    constexpr auto staticSquares = fox::make_static_flat_map<int, int>(
+            {{0, 0},
+             {1, 1},
+             {2, 4},
+             {3, 9},
+             {4, 16},
+             {5, 25},
+             {6, 36},
+             {7, 49},
+             {8, 64},
+             {9, 81},
+             {10, 100},
+             {11, 121},
+             {12, 144},
+             {13, 169},
+             {14, 196},
+             {15, 225}});
+
+    void BM_IntFlatMap(benchmark::State& state)
+    {
+        const fox::FlatMap<int, int> squares(
+                staticSquares.begin(), staticSquares.end());
+        int next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(squares.find(next));
+            next = (next * 7 + 3) % 19;
+        }
+    }
+
+    void BM_IntStaticFlatMap(benchmark::State& state)
+    {
+        int next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(staticSquares.find(next));
+            next = (next * 7 + 3) % 19;
+        }
+    }
+
+} // namespace
+
+BENCHMARK(BM_IntFlatMap);
+BENCHMARK(BM_IntStaticFlatMap);
+BENCHMARK(BM_KeywordFlatMap);
+BENCHMARK(BM_KeywordStaticFlatMap);
+BENCHMARK(BM_KeywordFlatMapBuild);
@@ -0,0 +1,62 @@
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+    using Map = fox::FlatMap<std::string, std::string>;
+
+    Map make_map(size_t count)
+    {
+        Map map(count);
+        for (size_t i = 0; i < count; ++i) {
+            map.insert("key/" + std::to_string(i), std::string(i % 100, 'v'));
+        }
+        return map;
+    }
+
+    // Text dump through operator<<, the previous checkpoint path.
+    void BM_WriteText(benchmark::State& state)
+    {
+        const Map map = make_map(static_cast<size_t>(state.range(0)));
+
+        for (auto _ : state) {
+            std::ostringstream out;
+            out << map;
+            benchmark::DoNotOptimize(out.tellp());
+        }
+    }
+
+    void BM_Serialize(benchmark::State& state)
+    {
+        const Map map = make_map(static_cast<size_t>(state.range(0)));
+
+        for (auto _ : state) {
+            std::ostringstream out;
+            map.serialize(out);
+            benchmark::DoNotOptimize(out.tellp());
+        }
+    }
+
+    void BM_Deserialize(benchmark::State& state)
+    {
+        std::ostringstream out;
+        make_map(static_cast<size_t>(state.range(0))).serialize(out);
+        const std::string image = out.str();
+
+        for (auto _ : state) {
+            std::istringstream in(image);
+            benchmark::DoNotOptimize(Map::deserialize(in));
+        }
+        state.SetBytesProcessed(
+                state.iterations() * static_cast<int64_t>(image.size()));
+    }
+
+} // namespace
+
+BENCHMARK(BM_WriteText)->Arg(100000);
+BENCHMARK(BM_Serialize)->Arg(100000);
+BENCHMARK(BM_Deserialize)->Arg(100000);
@@ -0,0 +1,456 @@
+#include "suite.hpp"
+
+#include "counters.hpp"
+
+#include <flatmap.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <map>
+#include <unordered_map>
+
+namespace fox::bench {
+    namespace {
+
+        template <size_t N>
+        struct Payload {
+            std::array<char, N> bytes{};
+        };
+
+        // Bijective scramblers, so distinct indices give distinct keys.
+        uint64_t mix64(uint64_t value)
+        {
+            value *= 0x9E3779B97F4A7C15ULL;
+            value ^= value >> 32U;
+            value *= 0xD6E8FEB86659FD93ULL;
+            return value ^ (value >> 29U);
+        }
+
+        uint32_t mix32(uint32_t value)
+        {
+            value *= 0x9E3779B1U;
+            value ^= value >> 16U;
+            value *= 0x85EBCA6BU;
+            return value ^ (value >> 13U);
+        }
+
+        struct IntKey {
+            using type = int64_t;
+
+            static std::string name()
+            {
+                return "int64";
+            }
+
+            static type make(uint64_t index)
+            {
+                return static_cast<type>(mix64(index));
+            }
+        };
+
+        // Keys share a long constant prefix, like URLs or paths do.
+        template <size_t Len>
+        struct StringKey {
+            using type = std::string;
+
+            static std::string name()
+            {
+                return "str" + std::to_string(Len);
+            }
+
+            static type make(uint64_t index)
+            {
+                static constexpr char digits[] = "0123456789abcdef";
+
+                const size_t width = Len < 16 ? 8 : 16;
+                uint64_t value = Len < 16
+                        ? mix32(static_cast<uint32_t>(index))
+                        : mix64(index);
+
+                std::string key(Len, 'k');
+                for (size_t i = 0; i < width; ++i) {
+                    key[Len - 1 - i] = digits[value & 0xFU];
+                    value >>= 4U;
+                }
+                return key;
+            }
+        };
+
+        // Sorted std::vector of pairs searched with std::lower_bound, the
+        // usual hand-rolled alternative to a flat map.
+        template <class Key, class Value>
+        class SortedVector {
+        public:
+            using value_type = std::pair<Key, Value>;
+            using iterator = typename std::vector<value_type>::iterator;
+
+            template <typename InputIt>
+            SortedVector(InputIt begin, InputIt end) : data_(begin, end)
+            {
+                std::sort(data_.begin(), data_.end(), less);
+                data_.erase(
+                        std::unique(
+                                data_.begin(),
+                                data_.end(),
+                                [](const auto& lhs, const auto& rhs) {
+                                    return lhs.first == rhs.first;
+                                }),
+                        data_.end());
+            }
+
+            iterator begin()
+            {
+                return data_.begin();
+            }
+            iterator end()
+            {
+                return data_.end();
+            }
+
+            iterator find(const Key& key)
+            {
+                auto iter = lower_bound(key);
+                return iter != end() && iter->first == key ? iter : end();
+            }
+
+            std::pair<iterator, bool>
+            try_emplace(const Key& key, const Value& value)
+            {
+                auto iter = lower_bound(key);
+                if (iter != end() && iter->first == key) {
+                    return {iter, false};
+                }
+                return {data_.emplace(iter, key, value), true};
+            }
+
+            size_t erase(const Key& key)
+            {
+                auto iter = find(key);
+                if (iter == end()) {
+                    return 0;
+                }
+                data_.erase(iter);
+                return 1;
+            }
+
+        private:
+            static bool less(const value_type& lhs, const value_type& rhs)
+            {
+                return lhs.first < rhs.first;
+            }
+
+            iterator lower_bound(const Key& key)
+            {
+                return std::lower_bound(
+                        data_.begin(),
+                        data_.end(),
+                        key,
+                        [](const value_type& element, const Key& key) {
+                            return element.first < key;
+                        });
+            }
+
+            std::vector<value_type> data_;
+        };
+
+        template <class K, class V>
+        using FoxFlatMap = fox::FlatMap<K, V>;
+        template <class K, class V>
+        using StdMap = std::map<K, V>;
+        template <class K, class V>
+        using StdUnorderedMap = std::unordered_map<K, V>;
+        template <class K, class V>
+        using StdSortedVector = SortedVector<K, V>;
+
+        enum class Pattern { Sequential, Uniform, Zipfian };
+
+        std::string pattern_name(Pattern pattern)
+        {
+            switch (pattern) {
+            case Pattern::Sequential:
+                return "seq";
+            case Pattern::Uniform:
+                return "uniform";
+            case Pattern::Zipfian:
+                return "zipf";
+            }
+            return "";
+        }
+
+        // Zipfian ranks in [0, count) following Gray et al., "Quickly
+        // generating billion-record synthetic databases" (as used by YCSB).
+        class ZipfianGenerator {
+        public:
+            explicit ZipfianGenerator(size_t count, double theta = 0.99)
+                : count_(count), theta_(theta)
+            {
+                for (size_t i = 1; i <= count; ++i) {
+                    zetan_ += 1.0 / std::pow(static_cast<double>(i), theta);
+                }
+                const double zeta2 = 1.0 + std::pow(0.5, theta);
+                alpha_ = 1.0 / (1.0 - theta);
+                const double head = 2.0 / static_cast<double>(count);
+                eta_ = (1.0 - std::pow(head, 1.0 - theta))
+                        / (1.0 - zeta2 / zetan_);
+            }
+
+            template <class Engine>
+            size_t operator()(Engine& engine)
+            {
+                const double u = std::uniform_real_distribution<>(0, 1)(engine);
+                const double uz = u * zetan_;
+                if (uz < 1.0) {
+                    return 0;
+                }
+                if (uz < 1.0 + std::pow(0.5, theta_)) {
+                    return 1;
+                }
+                const auto rank = static_cast<size_t>(
+                        static_cast<double>(count_)
+                        * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+                return std::min(rank, count_ - 1);
+            }
+
+        private:
+            size_t count_;
+            double theta_;
+            double zetan_ = 0;
+            double alpha_ = 0;
+            double eta_ = 0;
+        };
+
+        constexpr size_t probeCount = 1 << 16;
+
+        // Picks probe keys from `sortedKeys`: in key order, uniformly, or
+        // Zipf-distributed with the hot ranks scattered over the key space.
+        template <class Key>
+        std::vector<Key>
+        make_probes(const std::vector<Key>& sortedKeys, Pattern pattern)
+        {
+            const size_t count = sortedKeys.size();
+            std::mt19937_64 engine(42);
+            std::vector<Key> probes;
+            probes.reserve(probeCount);
+
+            switch (pattern) {
+            case Pattern::Sequential:
+                for (size_t i = 0; i < probeCount; ++i) {
+                    probes.push_back(sortedKeys[i % count]);
+                }
+                break;
+            case Pattern::Uniform: {
+                std::uniform_int_distribution<size_t> dist(0, count - 1);
+                for (size_t i = 0; i < probeCount; ++i) {
+                    probes.push_back(sortedKeys[dist(engine)]);
+                }
+                break;
+            }
+            case Pattern::Zipfian: {
+                ZipfianGenerator zipf(count);
+                for (size_t i = 0; i < probeCount; ++i) {
+                    probes.push_back(sortedKeys[mix64(zipf(engine)) % count]);
+                }
+                break;
+            }
+            }
+            return probes;
+        }
+
+        // Keys with even indices are stored in the map, odd ones are
+        // guaranteed misses used for insertion.
+        template <class KeyDesc>
+        std::vector<typename KeyDesc::type>
+        make_keys(size_t count, size_t parity)
+        {
+            std::vector<typename KeyDesc::type> keys;
+            keys.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                keys.push_back(KeyDesc::make(i * 2 + parity));
+            }
+            return keys;
+        }
+
+        template <class Key, class Value>
+        std::vector<std::pair<Key, Value>>
+        make_items(const std::vector<Key>& keys)
+        {
+            std::vector<std::pair<Key, Value>> items;
+            items.reserve(keys.size());
+            for (const auto& key : keys) {
+                items.emplace_back(key, Value{});
+            }
+            return items;
+        }
+
+        template <class Map, class KeyDesc, class Value>
+        void find(benchmark::State& state, Pattern pattern)
+        {
+            const auto count = static_cast<size_t>(state.range(0));
+            auto keys = make_keys<KeyDesc>(count, 0);
+            const auto items = make_items<typename KeyDesc::type, Value>(keys);
+            Map map(items.begin(), items.end());
+            std::sort(keys.begin(), keys.end());
+            const auto probes = make_probes(keys, pattern);
+
+            OpCounters counters;
+            counters.start();
+            size_t next = 0;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(map.find(probes[next]));
+                next = (next + 1) % probeCount;
+            }
+            counters.stop(state);
+        }
+
+        template <class Map, class KeyDesc, class Value>
+        void insert_erase(benchmark::State& state, Pattern pattern)
+        {
+            const auto count = static_cast<size_t>(state.range(0));
+            const auto keys = make_keys<KeyDesc>(count, 0);
+            const auto items = make_items<typename KeyDesc::type, Value>(keys);
+            Map map(items.begin(), items.end());
+            auto missing = make_keys<KeyDesc>(count, 1);
+            std::sort(missing.begin(), missing.end());
+            const auto probes = make_probes(missing, pattern);
+
+            OpCounters counters;
+            counters.start();
+            size_t next = 0;
+            for (auto _ : state) {
+                map.try_emplace(probes[next], Value{});
+                map.erase(probes[next]);
+                next = (next + 1) % probeCount;
+            }
+            counters.stop(state);
+        }
+
+        template <class Map, class KeyDesc, class Value>
+        void iterate(benchmark::State& state)
+        {
+            const auto count = static_cast<size_t>(state.range(0));
+            const auto keys = make_keys<KeyDesc>(count, 0);
+            const auto items = make_items<typename KeyDesc::type, Value>(keys);
+            Map map(items.begin(), items.end());
+
+            OpCounters counters;
+            counters.start();
+            for (auto _ : state) {
+                size_t sum = 0;
+                for (const auto& pair : map) {
+                    sum += static_cast<size_t>(pair.second.bytes[0]);
+                }
+                benchmark::DoNotOptimize(sum);
+            }
+            counters.stop(state);
+            state.SetItemsProcessed(
+                    state.iterations() * static_cast<int64_t>(count));
+        }
+
+        template <class Map, class KeyDesc, class Value>
+        void construct(benchmark::State& state)
+        {
+            const auto count = static_cast<size_t>(state.range(0));
+            const auto keys = make_keys<KeyDesc>(count, 0);
+            const auto items = make_items<typename KeyDesc::type, Value>(keys);
+
+            OpCounters counters;
+            counters.start();
+            for (auto _ : state) {
+                Map map(items.begin(), items.end());
+                benchmark::DoNotOptimize(map);
+            }
+            counters.stop(state);
+            state.SetItemsProcessed(
+                    state.iterations() * static_cast<int64_t>(count));
+        }
+
+        void apply_sizes(benchmark::internal::Benchmark* bench, size_t maxSize)
+        {
+            for (size_t size = 100; size <= maxSize; size *= 100) {
+                bench->Arg(static_cast<int64_t>(size));
+            }
+        }
+
+        template <
+                template <class, class>
+                class MapTemplate,
+                class KeyDesc,
+                class Value>
+        void register_case(
+                const std::string& container,
+                size_t valueSize,
+                size_t maxSize)
+        {
+            using Map = MapTemplate<typename KeyDesc::type, Value>;
+            const std::string suffix = "/" + container + "/" + KeyDesc::name()
+                    + "/v" + std::to_string(valueSize);
+
+            for (const auto pattern :
+                 {Pattern::Sequential, Pattern::Uniform, Pattern::Zipfian}) {
+                apply_sizes(
+                        benchmark::RegisterBenchmark(
+                                ("find" + suffix + "/" + pattern_name(pattern))
+                                        .c_str(),
+                                find<Map, KeyDesc, Value>,
+                                pattern),
+                        maxSize);
+                apply_sizes(
+                        benchmark::RegisterBenchmark(
+                                ("insert_erase" + suffix + "/"
+                                 + pattern_name(pattern))
+                                        .c_str(),
+                                insert_erase<Map, KeyDesc, Value>,
+                                pattern),
+                        maxSize);
+            }
+            apply_sizes(
+                    benchmark::RegisterBenchmark(
+                            ("iterate" + suffix).c_str(),
+                            iterate<Map, KeyDesc, Value>),
+                    maxSize);
+            apply_sizes(
+                    benchmark::RegisterBenchmark(
+                            ("construct" + suffix).c_str(),
+                            construct<Map, KeyDesc, Value>),
+                    maxSize);
+        }
+
+        template <template <class, class> class MapTemplate, class KeyDesc>
+        void register_values(const std::string& container, size_t maxSize)
+        {
+            register_case<MapTemplate, KeyDesc, Payload<8>>(
+                    container, 8, maxSize);
+            register_case<MapTemplate, KeyDesc, Payload<64>>(
+                    container, 64, maxSize);
+            register_case<MapTemplate, KeyDesc, Payload<256>>(
+                    container, 256, maxSize);
+        }
+
+        template <template <class, class> class MapTemplate>
+        void register_container(const std::string& container, size_t maxSize)
+        {
+            register_values<MapTemplate, IntKey>(container, maxSize);
+            register_values<MapTemplate, StringKey<8>>(container, maxSize);
+            register_values<MapTemplate, StringKey<32>>(container, maxSize);
+            register_values<MapTemplate, StringKey<128>>(container, maxSize);
+        }
+
+    } // namespace
+
+    void register_suite(size_t maxSize)
+    {
+        register_container<FoxFlatMap>("FlatMap", maxSize);
+        register_container<StdMap>("std::map", maxSize);
+        register_container<StdUnorderedMap>("std::unordered_map", maxSize);
+        register_container<StdSortedVector>("sorted_vector", maxSize);
+    }
+}; // namespace fox::bench
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fox::bench {
+
+    // Registers the container comparison matrix for map sizes from 100 up
+    // to `maxSize` in steps of 100x.
+    void register_suite(size_t maxSize);
+}; // namespace fox::bench
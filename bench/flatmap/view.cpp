@@ -0,0 +1,95 @@
+#include <flatmap.hpp>
+#include <flatmap_view.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Map = fox::FlatMap<uint64_t, uint64_t>;
+    using View = fox::FlatMapView<uint64_t, uint64_t>;
+
+    std::vector<std::pair<uint64_t, uint64_t>> make_items(size_t count)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> items(count);
+        for (size_t i = 0; i < count; ++i) {
+            items[i] = {i * 2, i};
+        }
+        return items;
+    }
+
+    std::string image_path(size_t count)
+    {
+        return "flatmap_view_bench_" + std::to_string(count) + ".bin";
+    }
+
+    std::vector<uint64_t> make_probes(size_t count)
+    {
+        std::mt19937_64 engine(42);
+        std::uniform_int_distribution<uint64_t> dist(0, count * 2);
+        std::vector<uint64_t> probes(1 << 16);
+        for (auto& probe : probes) {
+            probe = dist(engine);
+        }
+        return probes;
+    }
+
+    // Startup cost without an image: building the map from sorted pairs,
+    // which is the floor for any parse-and-insert loader.
+    void BM_BuildMap(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        const auto items = make_items(count);
+
+        for (auto _ : state) {
+            Map map(fox::sorted_unique, items.begin(), items.end());
+            benchmark::DoNotOptimize(map.find(count));
+        }
+    }
+
+    // Startup cost with an image: map the file and serve one lookup.
+    void BM_OpenView(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        const auto items = make_items(count);
+        const auto path = image_path(count);
+        Map(fox::sorted_unique, items.begin(), items.end()).save(path);
+
+        for (auto _ : state) {
+            const auto view = View::open(path);
+            benchmark::DoNotOptimize(view.find(count));
+        }
+        std::remove(path.c_str());
+    }
+
+    template <bool withIndex>
+    void BM_ViewFind(benchmark::State& state)
+    {
+        const auto count = static_cast<size_t>(state.range(0));
+        const auto items = make_items(count);
+        const auto path = image_path(count);
+        Map(fox::sorted_unique, items.begin(), items.end())
+                .save(path, withIndex);
+        const auto view = View::open(path);
+        const auto probes = make_probes(count);
+
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(view.find(probes[next]));
+            next = (next + 1) % probes.size();
+        }
+        std::remove(path.c_str());
+    }
+
+} // namespace
+
+BENCHMARK(BM_BuildMap)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK(BM_OpenView)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_ViewFind, true)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_ViewFind, false)->Arg(1 << 16)->Arg(1 << 22);
@@ -3,6 +3,9 @@ function(set_compile_options target_name)
     target_compile_options(${target_name} INTERFACE /W4 /WX /EHsc)
   else()
     target_compile_options(${target_name} INTERFACE -Wall -Wextra -Werror -pedantic)
+    if(FLATMAP_NATIVE_ARCH)
+      target_compile_options(${target_name} PRIVATE -march=native)
+    endif()
   endif()
 
   set_target_properties(
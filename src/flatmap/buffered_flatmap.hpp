@@ -0,0 +1,417 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <algorithm>
+
+#include <cassert>
+
+#include <iterator>
+
+#include <optional>
+
+#include <stdexcept>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A FlatMap for write bursts. Writes go to a small sorted delta buffer
+    // instead of shifting the main array; erasing a key of the main array
+    // records a tombstone. The delta is merged into the main array in
+    // linear time once it holds `bufferLimit` entries, or before anything
+    // hands out iterators (begin(), end(), find(), bounds).
+    //
+    // contains(), count(), at() and operator[] check the delta and then
+    // the main array without merging. The calls that merge are
+    // non-const, so any number of threads may read a map through const
+    // references, as with other containers. Their const overloads cannot
+    // merge and require a flushed map (pending() == 0). Insertion reports
+    // only whether the key was new, since an iterator would force a
+    // merge; otherwise the interface matches FlatMap, so callers that
+    // ignore insert results can switch between the two by changing the
+    // type.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class Allocator = std::allocator<std::pair<const Key, T>>>
+    class BufferedFlatMap {
+    public:
+        using map_type = FlatMap<Key, T, Compare, Allocator>;
+        using key_type = typename map_type::key_type;
+        using mapped_type = typename map_type::mapped_type;
+        using value_type = typename map_type::value_type;
+        using size_type = typename map_type::size_type;
+        using iterator = typename map_type::iterator;
+        using const_iterator = typename map_type::const_iterator;
+        using reverse_iterator = typename map_type::reverse_iterator;
+        using const_reverse_iterator =
+                typename map_type::const_reverse_iterator;
+
+    private:
+        // An empty value is a tombstone for a key of the main array.
+        using delta_entry = std::pair<Key, std::optional<T>>;
+
+        map_type main_;
+        std::vector<delta_entry> delta_;
+        size_t bufferLimit_;
+        size_t size_ = 0;
+        Compare compare_;
+
+    public:
+        explicit BufferedFlatMap(size_t bufferLimit = 1024)
+            : bufferLimit_(std::max<size_t>(1, bufferLimit))
+        {
+        }
+
+        explicit BufferedFlatMap(map_type map, size_t bufferLimit = 1024)
+            : main_(std::move(map)),
+              bufferLimit_(std::max<size_t>(1, bufferLimit)),
+              size_(main_.size())
+        {
+        }
+
+        iterator begin()
+        {
+            flush();
+            return main_.begin();
+        }
+
+        iterator end()
+        {
+            flush();
+            return main_.end();
+        }
+
+        reverse_iterator rbegin()
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend()
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_iterator begin() const
+        {
+            return flushed().begin();
+        }
+
+        const_iterator end() const
+        {
+            return flushed().end();
+        }
+
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        // Entries, including tombstones, waiting to be merged.
+        size_t pending() const
+        {
+            return delta_.size();
+        }
+
+        bool insert(const Key& key, const T& value)
+        {
+            return try_emplace(key, value);
+        }
+
+        bool insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        bool insert(value_type&& value)
+        {
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        template <class... Args>
+        bool try_emplace(const Key& key, Args&&... args)
+        {
+            auto delta = delta_lower_bound(key);
+            if (delta != delta_.end() && !compare_(key, delta->first)) {
+                if (delta->second) {
+                    return false;
+                }
+                delta->second.emplace(std::forward<Args>(args)...);
+                ++size_;
+                return true;
+            }
+
+            if (main_.contains(key)) {
+                return false;
+            }
+            delta_.emplace(
+                    delta,
+                    key,
+                    std::optional<T>(
+                            std::in_place, std::forward<Args>(args)...));
+            ++size_;
+            flush_if_full();
+            return true;
+        }
+
+        template <class M>
+        bool insert_or_assign(const Key& key, M&& value)
+        {
+            auto delta = delta_lower_bound(key);
+            if (delta != delta_.end() && !compare_(key, delta->first)) {
+                const bool inserted = !delta->second;
+                delta->second = std::forward<M>(value);
+                size_ += inserted ? 1 : 0;
+                return inserted;
+            }
+
+            // Existing keys are updated in place, which shifts nothing.
+            auto iter = main_.find(key);
+            if (iter != main_.end()) {
+                iter->second = std::forward<M>(value);
+                return false;
+            }
+            delta_.emplace(
+                    delta,
+                    key,
+                    std::optional<T>(std::in_place, std::forward<M>(value)));
+            ++size_;
+            flush_if_full();
+            return true;
+        }
+
+        T& operator[](const Key& key)
+        {
+            auto delta = delta_lower_bound(key);
+            if (delta != delta_.end() && !compare_(key, delta->first)) {
+                if (!delta->second) {
+                    delta->second.emplace();
+                    ++size_;
+                }
+                return *delta->second;
+            }
+
+            auto iter = main_.find(key);
+            if (iter != main_.end()) {
+                return iter->second;
+            }
+            delta = delta_.emplace(delta, key, std::optional<T>(std::in_place));
+            ++size_;
+            if (flush_if_full()) {
+                return main_.find(key)->second;
+            }
+            return *delta->second;
+        }
+
+        T& at(const Key& key)
+        {
+            return const_cast<T&>(std::as_const(*this).at(key));
+        }
+
+        const T& at(const Key& key) const
+        {
+            const size_t index = delta_position(key);
+            if (index < delta_.size() && !compare_(key, delta_[index].first)) {
+                if (delta_[index].second) {
+                    return *delta_[index].second;
+                }
+            } else if (auto iter = main_.find(key); iter != main_.end()) {
+                return iter->second;
+            }
+            throw std::out_of_range("Key not found in flatmap");
+        }
+
+        bool contains(const Key& key) const
+        {
+            const size_t index = delta_position(key);
+            if (index < delta_.size() && !compare_(key, delta_[index].first)) {
+                return delta_[index].second.has_value();
+            }
+            return main_.contains(key);
+        }
+
+        size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        size_t erase(const Key& key)
+        {
+            auto delta = delta_lower_bound(key);
+            if (delta != delta_.end() && !compare_(key, delta->first)) {
+                if (!delta->second) {
+                    return 0;
+                }
+                // A live entry shadows the main array only after a
+                // tombstone was overwritten; keep it as a tombstone then.
+                if (main_.contains(key)) {
+                    delta->second.reset();
+                } else {
+                    delta_.erase(delta);
+                }
+                --size_;
+                return 1;
+            }
+
+            if (!main_.contains(key)) {
+                return 0;
+            }
+            delta_.emplace(delta, key, std::nullopt);
+            --size_;
+            flush_if_full();
+            return 1;
+        }
+
+        iterator find(const Key& key)
+        {
+            flush();
+            return main_.find(key);
+        }
+
+        iterator lower_bound(const Key& key)
+        {
+            flush();
+            return main_.lower_bound(key);
+        }
+
+        iterator upper_bound(const Key& key)
+        {
+            flush();
+            return main_.upper_bound(key);
+        }
+
+        std::pair<iterator, iterator> equal_range(const Key& key)
+        {
+            flush();
+            return main_.equal_range(key);
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            return flushed().find(key);
+        }
+
+        const_iterator lower_bound(const Key& key) const
+        {
+            return flushed().lower_bound(key);
+        }
+
+        const_iterator upper_bound(const Key& key) const
+        {
+            return flushed().upper_bound(key);
+        }
+
+        std::pair<const_iterator, const_iterator>
+        equal_range(const Key& key) const
+        {
+            return flushed().equal_range(key);
+        }
+
+        void clear()
+        {
+            main_.clear();
+            delta_.clear();
+            size_ = 0;
+        }
+
+        // Merges the delta into the main array: one compaction pass drops
+        // tombstoned keys, then one merge pass adds the live entries.
+        void flush()
+        {
+            if (delta_.empty()) {
+                return;
+            }
+
+            auto tombstone = delta_.begin();
+            main_.erase_if([this, &tombstone](const value_type& element) {
+                while (tombstone != delta_.end()
+                       && (tombstone->second
+                           || compare_(tombstone->first, element.first))) {
+                    ++tombstone;
+                }
+                return tombstone != delta_.end()
+                        && !compare_(element.first, tombstone->first);
+            });
+
+            std::vector<std::pair<Key, T>> live;
+            live.reserve(delta_.size());
+            for (auto& [key, value] : delta_) {
+                if (value) {
+                    live.emplace_back(key, std::move(*value));
+                }
+            }
+            main_.merge(
+                    map_type(
+                            sorted_unique,
+                            std::make_move_iterator(live.begin()),
+                            std::make_move_iterator(live.end())),
+                    overwrite);
+            delta_.clear();
+        }
+
+        // Hands the merged map back.
+        map_type extract() &&
+        {
+            flush();
+            size_ = 0;
+            return std::move(main_);
+        }
+
+    private:
+        // The main array, for const calls that hand out iterators and so
+        // cannot see the delta.
+        const map_type& flushed() const
+        {
+            assert(delta_.empty() && "flush() before iterating a const map");
+            return main_;
+        }
+
+        size_t delta_position(const Key& key) const
+        {
+            return static_cast<size_t>(
+                    std::lower_bound(
+                            delta_.begin(),
+                            delta_.end(),
+                            key,
+                            [this](const delta_entry& entry, const Key& key) {
+                                return compare_(entry.first, key);
+                            })
+                    - delta_.begin());
+        }
+
+        typename std::vector<delta_entry>::iterator
+        delta_lower_bound(const Key& key)
+        {
+            return delta_.begin()
+                    + static_cast<std::ptrdiff_t>(delta_position(key));
+        }
+
+        bool flush_if_full()
+        {
+            if (delta_.size() < bufferLimit_) {
+                return false;
+            }
+            flush();
+            return true;
+        }
+    };
+}; // namespace fox
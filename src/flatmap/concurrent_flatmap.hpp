@@ -0,0 +1,266 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <atomic>
+
+#include <cstdint>
+
+#include <memory>
+
+#include <mutex>
+
+#include <stdexcept>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A FlatMap shared between many readers and a few writers. Readers
+    // see immutable snapshots published through an atomic pointer and
+    // never block, allocate or retry; writers copy the current snapshot,
+    // apply a batch of changes and publish the result. Replaced snapshots
+    // are freed with epoch-based reclamation once no reader can still
+    // hold them.
+    //
+    // Each reading thread claims a Reader (one of `maxReaders` slots, each
+    // on its own cache line) and pins a snapshot for the duration of a
+    // ReadGuard:
+    //
+    //     auto reader = map.reader();
+    //     {
+    //         auto snapshot = reader.pin();
+    //         auto it = snapshot->find(key);
+    //     }
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class Allocator = std::allocator<std::pair<const Key, T>>>
+    class ConcurrentFlatMap {
+    public:
+        using map_type = FlatMap<Key, T, Compare, Allocator>;
+        using key_type = typename map_type::key_type;
+        using mapped_type = typename map_type::mapped_type;
+        using value_type = typename map_type::value_type;
+        using size_type = typename map_type::size_type;
+
+    private:
+        // Epoch 0 marks a slot whose reader is outside any read section.
+        static constexpr uint64_t quiescent = 0;
+
+        struct alignas(64) Slot {
+            std::atomic<bool> claimed{false};
+            std::atomic<uint64_t> epoch{quiescent};
+        };
+
+        struct Retired {
+            const map_type* map;
+            uint64_t epoch;
+        };
+
+        std::atomic<const map_type*> current_;
+        std::atomic<uint64_t> epoch_{1};
+        std::unique_ptr<Slot[]> slots_;
+        size_t slotCount_;
+
+        mutable std::mutex writer_;
+        std::vector<Retired> retired_;
+
+    public:
+        class Reader;
+
+        // Keeps one snapshot alive. Iterators and references obtained
+        // through it stay valid until the guard is destroyed.
+        class ReadGuard {
+        public:
+            ReadGuard(ReadGuard&& other) noexcept
+                : slot_(std::exchange(other.slot_, nullptr)),
+                  map_(other.map_)
+            {
+            }
+
+            ReadGuard(const ReadGuard&) = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+            ReadGuard& operator=(ReadGuard&&) = delete;
+
+            ~ReadGuard()
+            {
+                if (slot_ != nullptr) {
+                    slot_->epoch.store(quiescent, std::memory_order_release);
+                }
+            }
+
+            const map_type& operator*() const
+            {
+                return *map_;
+            }
+
+            const map_type* operator->() const
+            {
+                return map_;
+            }
+
+        private:
+            friend class Reader;
+
+            ReadGuard(Slot* slot, const map_type* map) : slot_(slot), map_(map)
+            {
+            }
+
+            Slot* slot_;
+            const map_type* map_;
+        };
+
+        // A reader slot owned by one thread at a time. A reader holds at
+        // most one ReadGuard at a time.
+        class Reader {
+        public:
+            Reader(Reader&& other) noexcept
+                : owner_(std::exchange(other.owner_, nullptr)),
+                  slot_(std::exchange(other.slot_, nullptr))
+            {
+            }
+
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            Reader& operator=(Reader&&) = delete;
+
+            ~Reader()
+            {
+                if (slot_ != nullptr) {
+                    slot_->claimed.store(false, std::memory_order_release);
+                }
+            }
+
+            // Wait-free: announces the current epoch in this reader's slot,
+            // then loads the published snapshot. A writer that retires the
+            // snapshot afterwards sees the announcement and keeps it alive.
+            ReadGuard pin() const
+            {
+                slot_->epoch.store(owner_->epoch_.load());
+                return ReadGuard(slot_, owner_->current_.load());
+            }
+
+        private:
+            friend class ConcurrentFlatMap;
+
+            Reader(const ConcurrentFlatMap* owner, Slot* slot)
+                : owner_(owner), slot_(slot)
+            {
+            }
+
+            const ConcurrentFlatMap* owner_;
+            Slot* slot_;
+        };
+
+        explicit ConcurrentFlatMap(size_t maxReaders = 128)
+            : ConcurrentFlatMap(map_type(), maxReaders)
+        {
+        }
+
+        // The snapshot is allocated last: the destructor does not run if
+        // the constructor throws, so nothing else would free it.
+        explicit ConcurrentFlatMap(map_type map, size_t maxReaders = 128)
+            : current_(nullptr),
+              slots_(new Slot[maxReaders]),
+              slotCount_(maxReaders)
+        {
+            current_.store(new map_type(std::move(map)));
+        }
+
+        ConcurrentFlatMap(const ConcurrentFlatMap&) = delete;
+        ConcurrentFlatMap& operator=(const ConcurrentFlatMap&) = delete;
+
+        // All readers must have been destroyed.
+        ~ConcurrentFlatMap()
+        {
+            for (const auto& retired : retired_) {
+                delete retired.map;
+            }
+            delete current_.load();
+        }
+
+        // Claims a free reader slot; throws std::length_error when all
+        // `maxReaders` are in use.
+        Reader reader() const
+        {
+            for (size_t i = 0; i < slotCount_; ++i) {
+                bool expected = false;
+                if (!slots_[i].claimed.load(std::memory_order_relaxed)
+                    && slots_[i].claimed.compare_exchange_strong(
+                            expected, true, std::memory_order_acquire)) {
+                    return Reader(this, &slots_[i]);
+                }
+            }
+            throw std::length_error("ConcurrentFlatMap: too many readers");
+        }
+
+        // Copies the current snapshot, lets `mutate` change the copy and
+        // publishes it. Writers are serialized, so batching many changes
+        // into one call amortizes the copy.
+        template <typename Mutate>
+        void update(Mutate&& mutate)
+        {
+            std::lock_guard<std::mutex> lock(writer_);
+            auto next = std::make_unique<map_type>(*current_.load());
+            mutate(*next);
+            publish(std::move(next));
+        }
+
+        // Replaces the contents with `map` without copying.
+        void store(map_type map)
+        {
+            std::lock_guard<std::mutex> lock(writer_);
+            publish(std::make_unique<map_type>(std::move(map)));
+        }
+
+        // Number of replaced snapshots still waiting for readers to leave.
+        size_t retired() const
+        {
+            std::lock_guard<std::mutex> lock(writer_);
+            return retired_.size();
+        }
+
+        // Frees every retired snapshot that no reader can still see.
+        void reclaim()
+        {
+            std::lock_guard<std::mutex> lock(writer_);
+            reclaim_retired();
+        }
+
+    private:
+        void publish(std::unique_ptr<map_type> next)
+        {
+            retired_.reserve(retired_.size() + 1);
+            const map_type* previous = current_.exchange(next.release());
+            // Readers that announced an epoch up to this one may have
+            // loaded `previous`; later readers load `next`.
+            retired_.push_back({previous, epoch_.fetch_add(1)});
+            reclaim_retired();
+        }
+
+        void reclaim_retired()
+        {
+            uint64_t oldest = UINT64_MAX;
+            for (size_t i = 0; i < slotCount_; ++i) {
+                const uint64_t epoch = slots_[i].epoch.load();
+                if (epoch != quiescent && epoch < oldest) {
+                    oldest = epoch;
+                }
+            }
+
+            auto kept = retired_.begin();
+            for (auto& retired : retired_) {
+                if (retired.epoch < oldest) {
+                    delete retired.map;
+                } else {
+                    *kept++ = retired;
+                }
+            }
+            retired_.erase(kept, retired_.end());
+        }
+    };
+}; // namespace fox
@@ -12,37 +12,151 @@
 
 #include <initializer_list>
 
+#include <memory>
+
+#include <memory_resource>
+
+#include <tuple>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <vector>
+
+#include <flatmap_image.hpp>
+#include <flatmap_learned.hpp>
+#include <flatmap_prefix.hpp>
+#include <flatmap_search.hpp>
+#include <flatmap_stats.hpp>
+#include <flatmap_stream.hpp>
+
 namespace fox {
 
-    template <class Key, class T, class Compare = std::less<Key>>
-    class FlatMap {
+    struct sorted_unique_t {
+        explicit sorted_unique_t() = default;
+    };
+
+    // Tags a constructor argument range as already sorted by the map's
+    // comparator and free of duplicate keys.
+    inline constexpr sorted_unique_t sorted_unique{};
+
+    // Conflict policies for the batch insertion API. A policy is called as
+    // policy(existing, std::move(incoming)) whenever a key is already present.
+    struct keep_existing_t {
+        template <class T>
+        void operator()(T& /*existing*/, T&& /*incoming*/) const
+        {
+        }
+    };
+
+    struct overwrite_t {
+        template <class T>
+        void operator()(T& existing, T&& incoming) const
+        {
+            existing = std::move(incoming);
+        }
+    };
+
+    inline constexpr keep_existing_t keep_existing{};
+    inline constexpr overwrite_t overwrite{};
+
+    // `Stats` receives hooks for lookups, searches, element moves and
+    // allocations; see NoStats, the default that compiles them away, and
+    // FlatMapStats.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class Allocator = std::allocator<std::pair<const Key, T>>,
+            class Stats = NoStats>
+    class FlatMap : private Stats {
     public:
         using key_type = const Key;
         using mapped_type = T;
         using value_type = std::pair<key_type, mapped_type>;
+        using allocator_type = Allocator;
         using reference = value_type&;
         using const_reference = std::pair<key_type, const mapped_type>&;
         using size_type = size_t;
+        using stats_type = Stats;
 
     private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+        using staging_type = std::vector<
+                std::pair<Key, T>,
+                typename alloc_traits::template rebind_alloc<
+                        std::pair<Key, T>>>;
+
+        static_assert(
+                std::is_same_v<typename alloc_traits::value_type, value_type>,
+                "Allocator must allocate FlatMap::value_type");
+        static_assert(
+                std::is_same_v<typename alloc_traits::pointer, value_type*>,
+                "Allocator must use raw pointers");
+
+        // Elements are built as std::pair<Key, T> and handed out as the
+        // layout-identical value_type, whose key is const, as Boost's
+        // flat_map does. Mutable keys let shifts move-assign elements
+        // instead of copying every key they pass.
+        using storage_type = std::pair<Key, T>;
+
+        static_assert(
+                sizeof(storage_type) == sizeof(value_type)
+                        && alignof(storage_type) == alignof(value_type),
+                "std::pair<Key, T> must be laid out like value_type");
+
         value_type* data_ = nullptr;
         size_t size_ = 0;
+        size_t capacity_ = 0;
+        Allocator alloc_;
         Compare compare_;
 
+        // A map has at most one search index: a learned index for the
+        // keys that branchless search handles, a prefix cache for the
+        // others. One pointer holds either, and inserts and erases test
+        // only it.
+        static constexpr bool learned_search
+                = detail::use_learned_index<Key, Compare>;
+        static constexpr bool prefix_search = !learned_search
+                && detail::has_key_prefix<Key, Key>
+                && key_prefix_agrees<Key, Compare>::value;
+        using search_index = std::conditional_t<
+                learned_search,
+                detail::LearnedIndex<Key>,
+                detail::PrefixCache<Key>>;
+
+        std::unique_ptr<search_index> searchIndex_;
+
     public:
         template <class K, class V>
         class Iterator {
         public:
             using iterator_category = std::random_access_iterator_tag;
-            using value_type = std::pair<K, V>;
+            using value_type = std::pair<K, std::remove_const_t<V>>;
             using difference_type = std::ptrdiff_t;
-            using pointer = value_type*;
-            using reference = value_type&;
+            // A const V makes this a const_iterator over the same storage.
+            using pointer = std::conditional_t<
+                    std::is_const_v<V>,
+                    const value_type*,
+                    value_type*>;
+            using reference = std::conditional_t<
+                    std::is_const_v<V>,
+                    const value_type&,
+                    value_type&>;
 
             Iterator(pointer data) : data_(data)
             {
             }
 
+            // iterator converts to const_iterator.
+            template <
+                    class U,
+                    std::enable_if_t<std::is_same_v<V, const U>, int> = 0>
+            Iterator(const Iterator<K, U>& other) : data_(other.data_)
+            {
+            }
+
             reference operator*()
             {
                 return *data_;
@@ -139,120 +253,192 @@ namespace fox {
             }
 
         private:
+            template <class, class>
+            friend class Iterator;
+
             pointer data_ = nullptr;
         };
 
         FlatMap() = default;
 
-        FlatMap(size_t size) : data_(nullptr), compare_()
+        explicit FlatMap(const Allocator& alloc) : alloc_(alloc)
         {
-            if (size > 0) {
-                data_ = static_cast<value_type*>(
-                        ::operator new(size * sizeof(value_type)));
-            }
+        }
+
+        FlatMap(size_t capacity, const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+        {
+            reserve(capacity);
         }
 
         template <typename InputIt>
-        FlatMap(InputIt begin, InputIt end) : data_(nullptr), compare_()
+        FlatMap(InputIt begin,
+                InputIt end,
+                const Allocator& alloc = Allocator())
+            : alloc_(alloc)
         {
-            const size_t dist = std::distance(begin, end);
-            if (dist > 0) {
-                data_ = static_cast<value_type*>(
-                        ::operator new(dist * sizeof(value_type)));
+            staging_type staging(begin, end, staging_allocator());
 
-                try {
-                    for (auto iter = begin; iter != end; ++iter) {
-                        insert(iter->first, iter->second);
-                    }
-                } catch (const std::exception& e) {
-                    for (size_t i = 0; i < size_; ++i) {
-                        data_[i].~value_type();
-                    }
-                    ::operator delete(data_);
+            std::stable_sort(
+                    staging.begin(),
+                    staging.end(),
+                    [this](const auto& lhs, const auto& rhs) {
+                        return compare_(lhs.first, rhs.first);
+                    });
 
-                    std::cerr << e.what() << '\n';
-                    throw std::out_of_range("FlatMap: out of range");
-                }
-            }
+            // Equal keys are adjacent after the stable sort, so unique()
+            // keeps the first occurrence of each key from the input.
+            auto last = std::unique(
+                    staging.begin(),
+                    staging.end(),
+                    [this](const auto& lhs, const auto& rhs) {
+                        return !compare_(lhs.first, rhs.first)
+                                && !compare_(rhs.first, lhs.first);
+                    });
+
+            reserve(static_cast<size_t>(last - staging.begin()));
+            append_sorted(
+                    std::make_move_iterator(staging.begin()),
+                    std::make_move_iterator(last));
         }
 
-        FlatMap(std::initializer_list<value_type> list)
-            : data_(nullptr), compare_()
+        FlatMap(std::initializer_list<value_type> list,
+                const Allocator& alloc = Allocator())
+            : FlatMap(list.begin(), list.end(), alloc)
         {
-            const size_t dist = list.size();
-            if (dist > 0) {
-                data_ = static_cast<value_type*>(
-                        ::operator new(dist * sizeof(value_type)));
+        }
 
-                try {
-                    for (auto iter = list.begin(); iter != list.end(); ++iter) {
-                        insert(iter->first, iter->second);
-                    }
-                } catch (const std::exception& e) {
-                    for (size_t i = 0; i < size_; ++i) {
-                        data_[i].~value_type();
-                    }
-                    ::operator delete(data_);
+        template <typename InputIt>
+        FlatMap(sorted_unique_t /*unused*/,
+                InputIt begin,
+                InputIt end,
+                const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+        {
+            reserve(std::distance(begin, end));
+            append_sorted(begin, end);
+        }
 
-                    std::cerr << e.what() << '\n';
-                    throw std::out_of_range("FlatMap: out of range");
-                }
-            }
+        FlatMap(sorted_unique_t tag,
+                std::initializer_list<value_type> list,
+                const Allocator& alloc = Allocator())
+            : FlatMap(tag, list.begin(), list.end(), alloc)
+        {
         }
 
         ~FlatMap()
         {
-            for (size_t i = 0; i < size_; ++i) {
-                data_[i].~value_type();
-            }
-            if (data_ != nullptr) {
-                ::operator delete(data_);
-            }
+            release();
         }
 
         FlatMap(const FlatMap& other)
-            : data_(static_cast<value_type*>(
-                    ::operator new(other.size_ * sizeof(value_type)))),
-              size_(other.size_)
+            : FlatMap(
+                    other,
+                    alloc_traits::select_on_container_copy_construction(
+                            other.alloc_))
         {
-            for (size_t i = 0; i < size_; ++i) {
-                new (&data_[i]) value_type(other.data_[i]);
+        }
+
+        FlatMap(const FlatMap& other, const Allocator& alloc)
+            : alloc_(alloc), compare_(other.compare_)
+        {
+            reserve(other.size_);
+            append_sorted(other.data_, other.data_ + other.size_);
+            if (other.searchIndex_) {
+                searchIndex_
+                        = std::make_unique<search_index>(*other.searchIndex_);
             }
         }
 
         FlatMap& operator=(const FlatMap& other)
         {
             if (this != &other) {
-                FlatMap temp(other);
-                std::swap(data_, temp.data_);
-                std::swap(size_, temp.size_);
+                if constexpr (alloc_traits::
+                                      propagate_on_container_copy_assignment::
+                                              value) {
+                    if (alloc_ != other.alloc_) {
+                        release();
+                    }
+                    alloc_ = other.alloc_;
+                }
+
+                FlatMap temp(other, alloc_);
+                swap_storage(temp);
+                compare_ = other.compare_;
             }
             return *this;
         }
 
         FlatMap(FlatMap&& other) noexcept
-            : data_(other.data_), size_(other.size_)
+            : data_(other.data_),
+              size_(other.size_),
+              capacity_(other.capacity_),
+              alloc_(std::move(other.alloc_)),
+              compare_(std::move(other.compare_)),
+              searchIndex_(std::move(other.searchIndex_))
         {
             other.data_ = nullptr;
             other.size_ = 0;
+            other.capacity_ = 0;
         }
 
-        FlatMap& operator=(FlatMap&& other) noexcept
+        FlatMap(FlatMap&& other, const Allocator& alloc)
+            : alloc_(alloc), compare_(other.compare_)
+        {
+            if (alloc_ == other.alloc_) {
+                swap_storage(other);
+            } else {
+                reserve(other.size_);
+                append_sorted(
+                        std::make_move_iterator(other.data_),
+                        std::make_move_iterator(other.data_ + other.size_));
+            }
+        }
+
+        FlatMap& operator=(FlatMap&& other) noexcept(
+                alloc_traits::propagate_on_container_move_assignment::value
+                || alloc_traits::is_always_equal::value)
         {
             if (this != &other) {
-                for (size_t i = 0; i < size_; ++i) {
-                    data_[i].~value_type();
-                }
-                ::operator delete(data_);
-                data_ = other.data_;
-                size_ = other.size_;
+                constexpr bool propagate = alloc_traits::
+                        propagate_on_container_move_assignment::value;
 
-                other.data_ = nullptr;
-                other.size_ = 0;
+                if (propagate || alloc_ == other.alloc_) {
+                    release();
+                    if constexpr (propagate) {
+                        alloc_ = std::move(other.alloc_);
+                    }
+                    swap_storage(other);
+                } else {
+                    // Storage owned by an unequal allocator cannot be
+                    // adopted, so the elements are moved one by one.
+                    FlatMap temp(std::move(other), alloc_);
+                    swap_storage(temp);
+                }
+                compare_ = std::move(other.compare_);
             }
             return *this;
         }
 
+        void swap(FlatMap& other) noexcept
+        {
+            if constexpr (alloc_traits::propagate_on_container_swap::value) {
+                std::swap(alloc_, other.alloc_);
+            }
+            swap_storage(other);
+            std::swap(compare_, other.compare_);
+        }
+
+        friend void swap(FlatMap& lhs, FlatMap& rhs) noexcept
+        {
+            lhs.swap(rhs);
+        }
+
+        allocator_type get_allocator() const
+        {
+            return alloc_;
+        }
+
         using iterator = Iterator<key_type, mapped_type>;
         using const_iterator = Iterator<key_type, const mapped_type>;
         using reverse_iterator = std::reverse_iterator<iterator>;
@@ -295,242 +481,1127 @@ namespace fox {
 
         T& operator[](const Key& key)
         {
-            auto iter = std::lower_bound(
-                    begin(),
-                    end(),
-                    key,
-                    [this](const value_type& element, const Key& key) {
-                        return compare_(element.first, key);
+            return try_emplace(key).first->second;
+        }
+
+        T& operator[](Key&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        mapped_type& at(const key_type& key)
+        {
+            return at_impl(key);
+        }
+
+        const mapped_type& at(const key_type& key) const
+        {
+            return at_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        mapped_type& at(const K& key)
+        {
+            return at_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const mapped_type& at(const K& key) const
+        {
+            return at_impl(key);
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        // The insertion functions below report an existing key through the
+        // returned bool instead of throwing, like std::map.
+        std::pair<iterator, bool> insert(const Key& key, const T& value)
+        {
+            return try_emplace(key, value);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return emplace(std::move(value));
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            value_type value(std::forward<Args>(args)...);
+            auto iter = lower_bound_impl(value.first);
+
+            if (iter != end() && !(compare_(value.first, iter->first))) {
+                return {iter, false};
+            }
+
+            const size_t index = iter - begin();
+            insert_at(index, std::move(value));
+            return {begin() + index, true};
+        }
+
+        // Unlike emplace(), constructs nothing when the key is present.
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            return try_emplace_impl(key, std::forward<Args>(args)...);
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            return try_emplace_impl(
+                    std::move(key), std::forward<Args>(args)...);
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value)
+        {
+            return insert_or_assign_impl(key, std::forward<M>(value));
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value)
+        {
+            return insert_or_assign_impl(
+                    std::move(key), std::forward<M>(value));
+        }
+
+        template <typename InputIt>
+        void insert_range(InputIt begin, InputIt end)
+        {
+            insert_range(begin, end, keep_existing);
+        }
+
+        template <typename InputIt>
+        void insert_or_assign_range(InputIt begin, InputIt end)
+        {
+            insert_range(begin, end, overwrite);
+        }
+
+        // Sorts the batch once and merges it into the map in a single pass,
+        // reallocating at most once. Duplicates inside the batch are folded
+        // with `combine` in input order before the merge.
+        template <typename InputIt, class Combine>
+        void insert_range(InputIt begin, InputIt end, Combine combine)
+        {
+            staging_type staging(begin, end, staging_allocator());
+            if (staging.empty()) {
+                return;
+            }
+
+            std::stable_sort(
+                    staging.begin(),
+                    staging.end(),
+                    [this](const auto& lhs, const auto& rhs) {
+                        return compare_(lhs.first, rhs.first);
                     });
 
-            if (iter != end() && !(compare_(key, iter->first))) {
-                return iter->second;
+            size_t last = 0;
+            for (size_t i = 1; i < staging.size(); ++i) {
+                if (compare_(staging[last].first, staging[i].first)) {
+                    ++last;
+                    if (last != i) {
+                        staging[last] = std::move(staging[i]);
+                    }
+                } else {
+                    combine(staging[last].second, std::move(staging[i].second));
+                }
             }
+            staging.erase(staging.begin() + last + 1, staging.end());
 
-            auto* newData = static_cast<value_type*>(
-                    ::operator new((size_ + 1) * sizeof(value_type)));
+            merge_sorted(staging.begin(), staging.size(), combine);
+        }
 
-            const size_t insertIndex = iter - data_;
+        void merge(FlatMap&& other)
+        {
+            merge(std::move(other), keep_existing);
+        }
 
-            for (size_t i = 0; i < insertIndex; ++i) {
-                new (&newData[i]) value_type(std::move(data_[i]));
+        template <class Combine>
+        void merge(FlatMap&& other, Combine combine)
+        {
+            if (this == &other) {
+                return;
             }
 
-            new (&newData[insertIndex]) value_type(key, mapped_type());
+            merge_sorted(other.data_, other.size_, combine);
+            other.clear();
+        }
+
+        iterator erase(iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
 
-            for (size_t i = insertIndex; i < size_; ++i) {
-                new (&newData[i + 1]) value_type(std::move(data_[i]));
+        // Removes [first, last) with one compaction pass and keeps the
+        // capacity.
+        iterator erase(iterator first, iterator last)
+        {
+            const size_t index = first - begin();
+            erase_at(index, last - first);
+            return begin() + index;
+        }
+
+        // Removes every element for which pred(element) holds in one pass
+        // and returns the number removed.
+        template <class Pred>
+        size_t erase_if(Pred pred)
+        {
+            size_t kept = 0;
+            size_t moved = 0;
+            for (size_t i = 0; i < size_; ++i) {
+                if (pred(static_cast<const value_type&>(data_[i]))) {
+                    continue;
+                }
+
+                if (kept != i) {
+                    storage(data_[kept]) = std::move(storage(data_[i]));
+                    ++moved;
+                }
+                ++kept;
+            }
+            this->record_moves(moved);
+
+            const size_t removed = size_ - kept;
+            for (size_t i = kept; i < size_; ++i) {
+                destroy(&data_[i]);
             }
+            size_ = kept;
+            note_shift(removed);
+            if (removed > 0) {
+                refresh_prefixes();
+            }
+
+            return removed;
+        }
 
+        bool erase(const Key& key)
+        {
+            return erase_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0,
+                std::enable_if_t<!std::is_convertible_v<K, iterator>, int> = 0>
+        bool erase(const K& key)
+        {
+            return erase_impl(key);
+        }
+
+        iterator find(const key_type& key) const
+        {
+            return find_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        iterator find(const K& key) const
+        {
+            return find_impl(key);
+        }
+
+        bool contains(const Key& key) const
+        {
+            return find(key) != end();
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        bool contains(const K& key) const
+        {
+            return find_impl(key) != end();
+        }
+
+        // Looks up every key in [first, last) and writes one iterator per
+        // key to `out` (end() for misses). The searches of up to
+        // detail::batch_group keys are interleaved, which pays off on maps
+        // larger than the cache. The key iterators must yield key_type
+        // lvalues.
+        template <typename KeyIt, typename OutputIt>
+        OutputIt find_batch(KeyIt first, KeyIt last, OutputIt out) const
+        {
+            batch_impl(first, last, [&out](iterator iter, bool) {
+                *out++ = iter;
+            });
+            return out;
+        }
+
+        // Like find_batch(), writing whether each key is present.
+        template <typename KeyIt, typename OutputIt>
+        OutputIt contains_batch(KeyIt first, KeyIt last, OutputIt out) const
+        {
+            batch_impl(first, last, [&out](iterator, bool found) {
+                *out++ = found;
+            });
+            return out;
+        }
+
+        size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        size_t count(const K& key) const
+        {
+            return find_impl(key) != end() ? 1 : 0;
+        }
+
+        iterator lower_bound(const Key& key) const
+        {
+            return lower_bound_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        iterator lower_bound(const K& key) const
+        {
+            return lower_bound_impl(key);
+        }
+
+        iterator upper_bound(const Key& key) const
+        {
+            return upper_bound_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        iterator upper_bound(const K& key) const
+        {
+            return upper_bound_impl(key);
+        }
+
+        std::pair<iterator, iterator> equal_range(const Key& key) const
+        {
+            return equal_range_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        std::pair<iterator, iterator> equal_range(const K& key) const
+        {
+            return equal_range_impl(key);
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        // Destroys all elements but keeps the buffer.
+        void clear()
+        {
             for (size_t i = 0; i < size_; ++i) {
-                data_[i].~value_type();
+                destroy(&data_[i]);
             }
+            size_ = 0;
+            searchIndex_.reset();
+        }
 
-            if (data_ != nullptr) {
-                ::operator delete(data_);
+        void reserve(size_t capacity)
+        {
+            if (capacity > capacity_) {
+                reallocate(capacity);
             }
+        }
 
-            ++size_;
-            data_ = newData;
+        void shrink_to_fit()
+        {
+            if (capacity_ > size_) {
+                reallocate(size_);
+            }
+        }
 
-            return newData[insertIndex].second;
+        // Counters of this map's work; snapshot() and reset() them.
+        const Stats& stats() const
+        {
+            return *this;
         }
 
-        mapped_type& at(const key_type& key)
+        Stats& stats()
         {
-            auto iter = find(key);
+            return *this;
+        }
 
-            if (iter != end()) {
-                return iter->second;
+        // Fits a piecewise-linear model of key positions that predicts
+        // each key's index to within `epsilon`, so that find() and
+        // lower_bound() search about 2 * epsilon elements instead of the
+        // whole map. Inserts and erases keep the model usable while
+        // widening the search by the distance they shift elements; past
+        // `epsilon` in total it is dropped and lookups fall back to
+        // binary search until the index is built again. Only for
+        // arithmetic keys in their natural order.
+        void build_learned_index(size_t epsilon = 8)
+        {
+            static_assert(
+                    detail::use_learned_index<Key, Compare>,
+                    "learned indexes need arithmetic keys ordered by less");
+
+            searchIndex_.reset();
+            if (size_ > 0) {
+                searchIndex_ = std::make_unique<search_index>(
+                        data_,
+                        size_,
+                        epsilon,
+                        [](const value_type& element) {
+                            return element.first;
+                        });
             }
+        }
 
-            throw std::out_of_range("Key not found in flatmap");
+        bool has_learned_index() const
+        {
+            return learned_search && searchIndex_ != nullptr;
         }
 
-        const mapped_type& at(const key_type& key) const
+        // Bytes used by the learned index, zero without one.
+        size_t learned_index_bytes() const
         {
-            auto iter = std::lower_bound(
-                    begin(),
-                    end(),
-                    key,
-                    [this](const value_type& element, const Key& key) {
-                        return compare_(element.first, key);
+            return has_learned_index() ? searchIndex_->bytes() : 0;
+        }
+
+        // Keeps the key_prefix of every key in a side array, so that a
+        // search compares 64-bit integers in contiguous memory and calls
+        // Compare only among the few elements whose prefix ties with the
+        // probe's. Inserts and erases keep the cache up to date. Needs a
+        // key_prefix specialization that agrees with Compare, as the
+        // ones for std::string and std::string_view do for std::less;
+        // other comparators must opt in through key_prefix_agrees.
+        // Keys that mostly share their first eight bytes, such as URLs
+        // with a common scheme, tie everywhere and gain nothing. Keys
+        // that branchless search handles, such as integers, search
+        // faster without it and are rejected.
+        void build_prefix_cache()
+        {
+            static_assert(
+                    !detail::use_branchless_search<Key, Compare>,
+                    "these keys use branchless search, which the prefix "
+                    "cache cannot speed up");
+            static_assert(
+                    detail::has_key_prefix<Key, Key>,
+                    "prefix caches need a fox::key_prefix<Key>");
+            static_assert(
+                    key_prefix_agrees<Key, Compare>::value,
+                    "key_prefix<Key> must order keys like Compare; "
+                    "see fox::key_prefix_agrees");
+
+            searchIndex_ = std::make_unique<search_index>(
+                    data_, size_, [](const value_type& element) {
+                        return element.first;
                     });
+        }
 
-            if (iter != end() && !(compare_(key, iter->first))) {
-                return iter->second;
-            }
+        bool has_prefix_cache() const
+        {
+            return prefix_search && searchIndex_ != nullptr;
+        }
 
-            throw std::out_of_range("Key not found in flatmap");
+        // Bytes used by the prefix cache, zero without one.
+        size_t prefix_cache_bytes() const
+        {
+            return has_prefix_cache() ? searchIndex_->bytes() : 0;
         }
-        bool empty() const
+
+        // Writes a binary image that FlatMapView::open() maps in place:
+        // a header, the sorted keys, the values and, unless `withIndex`
+        // is false, a sparse index over the keys. Requires trivially
+        // copyable keys and values; throws std::system_error on I/O
+        // failure.
+        void save(const std::string& path, bool withIndex = true) const
         {
-            return size_ == 0;
+            detail::write_image<Key, T>(path, data_, size_, withIndex);
+        }
+
+        // Writes the elements in key order as a stream of checksummed
+        // blocks, encoding keys and values with fox::codec. Memory use is
+        // bounded by one block.
+        void serialize(
+                std::ostream& out,
+                const SerializeOptions& options = SerializeOptions()) const
+        {
+            detail::OstreamSink sink{out};
+            serialize_to(sink, options);
+        }
+
+        // Reads a map written by serialize(). Elements are constructed
+        // in place one block at a time, without searching. The buffer
+        // grows with the elements decoded, up to the stored count, so a
+        // corrupt count cannot allocate more than the stream holds.
+        // Throws std::runtime_error on malformed, unsorted or corrupted
+        // input.
+        static FlatMap
+        deserialize(std::istream& in, const Allocator& alloc = Allocator())
+        {
+            detail::IstreamSource source{in};
+            return deserialize_from(source, alloc);
+        }
+
+        // serialize() to any sink with a write(const char*, size_t) that
+        // throws on failure; flatmap_fd.hpp has one for file descriptors.
+        template <class Sink>
+        void serialize_to(Sink& sink, const SerializeOptions& options) const
+        {
+            detail::BlockWriter<Sink> writer(sink, options, size_);
+            for (size_t i = 0; i < size_; ++i) {
+                codec<Key>::encode(writer.payload(), data_[i].first);
+                codec<T>::encode(writer.payload(), data_[i].second);
+                writer.end_element();
+            }
+            writer.finish();
+        }
+
+        // deserialize() from any source with a read(char*, size_t) that
+        // fills the whole buffer or throws.
+        template <class Source>
+        static FlatMap deserialize_from(Source& source, const Allocator& alloc)
+        {
+            detail::BlockReader<Source> reader(source);
+            FlatMap map(alloc);
+            const uint64_t count = reader.count();
+
+            while (const size_t elements = reader.next_block()) {
+                if (elements > count - map.size_) {
+                    throw std::runtime_error("FlatMap: element count mismatch");
+                }
+                // Every element takes at least a byte with the built-in
+                // codecs, so the payload bounds what the block can hold.
+                auto payload = reader.payload();
+                map.grow_for(std::min(elements, payload.remaining()), count);
+                for (size_t i = 0; i < elements; ++i) {
+                    Key key = codec<Key>::decode(payload);
+                    T value = codec<T>::decode(payload);
+                    if (map.size_ > 0
+                        && !map.compare_(map.data_[map.size_ - 1].first, key)) {
+                        throw std::runtime_error("FlatMap: keys out of order");
+                    }
+                    if (map.size_ == map.capacity_) {
+                        map.grow_for(1, count);
+                    }
+                    map.construct(
+                            &map.data_[map.size_],
+                            std::move(key),
+                            std::move(value));
+                    ++map.size_;
+                }
+                if (payload.remaining() != 0) {
+                    throw std::runtime_error("FlatMap: malformed block");
+                }
+            }
+
+            if (map.size_ != count) {
+                throw std::runtime_error("FlatMap: element count mismatch");
+            }
+            return map;
         }
 
-        void insert(const Key& key, const T& value)
+    private:
+        template <class K>
+        iterator lower_bound_impl(const K& key) const
         {
+            if constexpr (
+                    detail::use_branchless_search<Key, Compare>
+                    && std::is_same_v<K, Key>) {
+                size_t first = 0;
+                size_t last = size_;
+                if (searchIndex_) {
+                    std::tie(first, last) = searchIndex_->window(key, size_);
+                }
+                // Counted for the Stats policy; dead code without one.
+                size_t comparisons = 0;
+                const size_t index = first
+                        + detail::lower_bound_index(
+                                data_ + first,
+                                last - first,
+                                key,
+                                [&comparisons](const value_type& element) {
+                                    ++comparisons;
+                                    return element.first;
+                                });
+                this->record_search(comparisons);
+                return begin() + static_cast<std::ptrdiff_t>(index);
+            }
+
+            auto [first, last] = search_window(key);
+            size_t comparisons = 0;
             auto iter = std::lower_bound(
-                    begin(),
-                    end(),
+                    first,
+                    last,
                     key,
-                    [this](const value_type& element, const Key& key) {
+                    [this, &comparisons](
+                            const value_type& element, const K& key) {
+                        ++comparisons;
                         return compare_(element.first, key);
                     });
+            this->record_search(comparisons);
+            return iter;
+        }
+
+        template <class K>
+        iterator upper_bound_impl(const K& key) const
+        {
+            auto [first, last] = search_window(key);
+            size_t comparisons = 0;
+            auto iter = std::upper_bound(
+                    first,
+                    last,
+                    key,
+                    [this, &comparisons](
+                            const K& key, const value_type& element) {
+                        ++comparisons;
+                        return compare_(key, element.first);
+                    });
+            this->record_search(comparisons);
+            return iter;
+        }
+
+        // Range holding both bounds of `key`: the whole map, or the
+        // elements around those whose prefix ties with the key's.
+        template <class K>
+        std::pair<iterator, iterator> search_window(const K& key) const
+        {
+            if constexpr (prefix_search && detail::has_key_prefix<Key, K>) {
+                if (searchIndex_) {
+                    const auto [first, last] = searchIndex_->window(key);
+                    return {begin() + static_cast<std::ptrdiff_t>(first),
+                            begin() + static_cast<std::ptrdiff_t>(last)};
+                }
+            }
+            return {begin(), end()};
+        }
+
+        template <class K>
+        std::pair<iterator, iterator> equal_range_impl(const K& key) const
+        {
+            auto iter = lower_bound_impl(key);
 
             if (iter != end() && !(compare_(key, iter->first))) {
-                throw(std::invalid_argument("Key already exists"));
+                return {iter, iter + 1};
             }
 
-            auto* newData = static_cast<value_type*>(
-                    ::operator new((size_ + 1) * sizeof(value_type)));
+            return {iter, iter};
+        }
+
+        template <class K>
+        iterator find_impl(const K& key) const
+        {
+            auto iter = lower_bound_impl(key);
+            const bool hit = iter != end() && !(compare_(key, iter->first));
+            this->record_lookup(hit);
 
-            const size_t insertIndex = iter - data_;
+            return hit ? iter : end();
+        }
+
+        template <typename KeyIt, typename Emit>
+        void batch_impl(KeyIt first, KeyIt last, Emit emit) const
+        {
+            const key_type* keys[detail::batch_group];
+            size_t indices[detail::batch_group];
+
+            while (first != last) {
+                size_t count = 0;
+                for (; count < detail::batch_group && first != last;
+                     ++count, ++first) {
+                    keys[count] = std::addressof(*first);
+                }
 
-            for (size_t i = 0; i < insertIndex; ++i) {
-                new (&newData[i]) value_type(std::move(data_[i]));
+                detail::lower_bound_batch(
+                        data_,
+                        size_,
+                        keys,
+                        count,
+                        indices,
+                        [this](const value_type& element, const Key& key) {
+                            return compare_(element.first, key);
+                        });
+
+                for (size_t i = 0; i < count; ++i) {
+                    const bool found = indices[i] < size_
+                            && !compare_(*keys[i], data_[indices[i]].first);
+                    this->record_lookup(found);
+                    emit(found ? begin() + static_cast<std::ptrdiff_t>(
+                                         indices[i])
+                               : end(),
+                         found);
+                }
             }
+        }
 
-            new (&newData[insertIndex]) value_type(key, value);
+        template <class K>
+        mapped_type& at_impl(const K& key) const
+        {
+            auto iter = find_impl(key);
 
-            for (size_t i = insertIndex; i < size_; ++i) {
-                new (&newData[i + 1]) value_type(std::move(data_[i]));
+            if (iter != end()) {
+                return iter->second;
             }
 
-            for (size_t i = 0; i < size_; ++i) {
-                data_[i].~value_type();
+            throw std::out_of_range("Key not found in flatmap");
+        }
+
+        template <class K, class... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args)
+        {
+            auto iter = lower_bound_impl(key);
+
+            if (iter != end() && !(compare_(key, iter->first))) {
+                return {iter, false};
             }
 
-            if (data_ != nullptr) {
-                ::operator delete(data_);
+            const size_t index = iter - begin();
+            insert_at(
+                    index,
+                    std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(key)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            return {begin() + index, true};
+        }
+
+        template <class K, class M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& value)
+        {
+            auto iter = lower_bound_impl(key);
+
+            if (iter != end() && !compare_(key, iter->first)) {
+                iter->second = std::forward<M>(value);
+                return {iter, false};
             }
 
-            ++size_;
-            data_ = newData;
+            const size_t index = iter - begin();
+            insert_at(index, std::forward<K>(key), std::forward<M>(value));
+            return {begin() + index, true};
+        }
+
+        template <class K>
+        bool erase_impl(const K& key)
+        {
+            auto iter = find_impl(key);
+
+            if (iter != end()) {
+                erase_at(iter - begin());
+                return true;
+            }
+
+            return false;
         }
 
-        void insert(const value_type& value)
+        size_t next_capacity() const
         {
-            insert(value.first, value.second);
+            return capacity_ == 0 ? 1 : capacity_ * 2;
         }
 
-        void insert_or_assign(const Key& key, const T& value)
+        // Makes room for `extra` more elements, growing geometrically but
+        // never past `limit` elements in total.
+        void grow_for(size_t extra, uint64_t limit)
         {
-            auto iter = std::lower_bound(
-                    begin(),
-                    end(),
-                    key,
-                    [this](const value_type& element, const Key& key) {
-                        return compare_(element.first, key);
-                    });
+            if (extra > capacity_ - size_) {
+                const size_t wanted = std::max(size_ + extra, next_capacity());
+                reserve(static_cast<size_t>(
+                        std::min<uint64_t>(limit, wanted)));
+            }
+        }
 
-            if (iter != end() && !compare_(key, iter->first)) {
-                iter->second = value;
-            } else {
-                auto* newData = static_cast<value_type*>(
-                        ::operator new((size_ + 1) * sizeof(value_type)));
+        value_type* allocate(size_t count)
+        {
+            if (count == 0) {
+                return nullptr;
+            }
+            this->record_allocation(count, count * sizeof(value_type));
+            return alloc_traits::allocate(alloc_, count);
+        }
 
-                const size_t insertIndex = iter - data_;
+        void deallocate(value_type* data, size_t count)
+        {
+            if (data != nullptr) {
+                alloc_traits::deallocate(alloc_, data, count);
+            }
+        }
 
-                for (size_t i = 0; i < insertIndex; ++i) {
-                    new (&newData[i]) value_type(std::move(data_[i]));
-                }
+        template <class... Args>
+        void construct(value_type* slot, Args&&... args)
+        {
+            alloc_traits::construct(
+                    alloc_,
+                    reinterpret_cast<storage_type*>(slot),
+                    std::forward<Args>(args)...);
+        }
 
-                new (&newData[insertIndex]) value_type(key, value);
+        void destroy(value_type* slot)
+        {
+            alloc_traits::destroy(alloc_, &storage(*slot));
+        }
 
-                for (size_t i = insertIndex; i < size_; ++i) {
-                    new (&newData[i + 1]) value_type(std::move(data_[i]));
-                }
+        static storage_type& storage(value_type& element)
+        {
+            return *std::launder(reinterpret_cast<storage_type*>(&element));
+        }
 
-                for (size_t i = 0; i < size_; ++i) {
-                    data_[i].~value_type();
-                }
+        // The element as an rvalue unless moving it may throw, so that a
+        // failed reallocation leaves the old buffer intact.
+        static decltype(auto) take(value_type& element)
+        {
+            return std::move_if_noexcept(storage(element));
+        }
 
-                if (data_ != nullptr) {
-                    ::operator delete(data_);
+        // Allocates `capacity` slots and has fill(slot, i) construct the
+        // first `count` of them in order. If one throws, the elements
+        // built so far are destroyed and the buffer is freed again.
+        template <class Fill>
+        value_type* build_buffer(size_t capacity, size_t count, Fill fill)
+        {
+            value_type* newData = allocate(capacity);
+            size_t built = 0;
+            try {
+                for (; built < count; ++built) {
+                    fill(&newData[built], built);
+                }
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) {
+                    destroy(&newData[i]);
                 }
+                deallocate(newData, capacity);
+                throw;
+            }
+            return newData;
+        }
 
-                ++size_;
-                data_ = newData;
+        // Replaces the buffer with `newData`, whose first `size_` slots
+        // already hold the elements.
+        void adopt_buffer(value_type* newData, size_t capacity)
+        {
+            for (size_t i = 0; i < size_; ++i) {
+                destroy(&data_[i]);
             }
+            deallocate(data_, capacity_);
+            data_ = newData;
+            capacity_ = capacity;
         }
 
-        bool erase(const Key& key)
+        // Destroys the elements and returns the buffer to the allocator.
+        void release()
         {
-            auto iter = std::lower_bound(
-                    begin(),
-                    end(),
-                    key,
-                    [this](const value_type& element, const Key& key) {
-                        return compare_(element.first, key);
-                    });
+            for (size_t i = 0; i < size_; ++i) {
+                destroy(&data_[i]);
+            }
+            deallocate(data_, capacity_);
+            data_ = nullptr;
+            size_ = 0;
+            capacity_ = 0;
+            searchIndex_.reset();
+        }
 
-            if (iter != end() && !(compare_(key, iter->first))) {
-                auto* newData = static_cast<value_type*>(
-                        ::operator new((size_ - 1) * sizeof(value_type)));
+        void swap_storage(FlatMap& other) noexcept
+        {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+            std::swap(searchIndex_, other.searchIndex_);
+        }
+
+        typename staging_type::allocator_type staging_allocator() const
+        {
+            return typename staging_type::allocator_type(alloc_);
+        }
 
-                const size_t insertIndex = iter - data_;
+        // Moves the elements into a buffer of exactly `capacity` slots.
+        void reallocate(size_t capacity)
+        {
+            value_type* newData = build_buffer(
+                    capacity, size_, [this](value_type* slot, size_t i) {
+                        construct(slot, take(data_[i]));
+                    });
+            this->record_moves(size_);
+            adopt_buffer(newData, capacity);
+        }
 
-                for (size_t i = 0; i < insertIndex; ++i) {
-                    new (&newData[i]) value_type(std::move(data_[i]));
+        // The new element is built first, so that a throwing constructor
+        // leaves the map as it was. Shifting then move-assigns elements
+        // one slot up, and only the slot past the end is constructed.
+        template <class... Args>
+        value_type& insert_at(size_t index, Args&&... args)
+        {
+            if (index == size_ && size_ < capacity_) {
+                construct(&data_[index], std::forward<Args>(args)...);
+                ++size_;
+            } else {
+                storage_type value(std::forward<Args>(args)...);
+                if (size_ == capacity_) {
+                    const size_t newCapacity = next_capacity();
+                    value_type* newData = build_buffer(
+                            newCapacity,
+                            size_ + 1,
+                            [&](value_type* slot, size_t i) {
+                                if (i == index) {
+                                    construct(
+                                            slot, std::move_if_noexcept(value));
+                                } else {
+                                    construct(
+                                            slot,
+                                            take(data_[i < index ? i : i - 1]));
+                                }
+                            });
+                    this->record_moves(size_);
+                    adopt_buffer(newData, newCapacity);
+                    ++size_;
+                } else {
+                    const size_t last = size_;
+                    this->record_moves(last - index);
+                    construct(
+                            &data_[last], std::move(storage(data_[last - 1])));
+                    ++size_;
+                    for (size_t i = last - 1; i > index; --i) {
+                        storage(data_[i]) = std::move(storage(data_[i - 1]));
+                    }
+                    storage(data_[index]) = std::move(value);
                 }
+            }
 
-                for (size_t i = insertIndex + 1; i < size_; ++i) {
-                    new (&newData[i - 1]) value_type(std::move(data_[i]));
+            note_shift(1);
+            if constexpr (prefix_search) {
+                if (searchIndex_) {
+                    update_prefixes([&] {
+                        searchIndex_->insert(index, data_[index].first);
+                    });
                 }
+            }
+            return data_[index];
+        }
 
-                for (size_t i = 0; i < size_; ++i) {
-                    data_[i].~value_type();
+        // Merges `count` sorted, unique elements of `batch` into the map.
+        // Conflicting keys are resolved by `combine` in a forward pass; the
+        // remaining keys are then merged from the back, in place when the
+        // capacity suffices and into one new buffer otherwise.
+        template <typename RandomIt, class Combine>
+        void merge_sorted(RandomIt batch, size_t count, Combine combine)
+        {
+            std::vector<
+                    size_t,
+                    typename alloc_traits::template rebind_alloc<size_t>>
+                    fresh(alloc_);
+            fresh.reserve(count);
+
+            size_t pos = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const auto& key = batch[i].first;
+                while (pos < size_ && compare_(data_[pos].first, key)) {
+                    ++pos;
                 }
 
-                if (data_ != nullptr) {
-                    ::operator delete(data_);
+                if (pos < size_ && !compare_(key, data_[pos].first)) {
+                    combine(data_[pos].second, std::move(batch[i].second));
+                } else {
+                    fresh.push_back(i);
                 }
+            }
 
-                --size_;
-                data_ = newData;
+            if (fresh.empty()) {
+                return;
+            }
+            note_shift(fresh.size());
+
+            const size_t newSize = size_ + fresh.size();
+            if (newSize > capacity_) {
+                const size_t newCapacity = std::max(newSize, next_capacity());
+                size_t src = 0;
+                size_t next = 0;
+                value_type* newData = build_buffer(
+                        newCapacity,
+                        newSize,
+                        [&](value_type* slot, size_t) {
+                            if (next == fresh.size()
+                                || (src < size_
+                                    && compare_(
+                                            data_[src].first,
+                                            batch[fresh[next]].first))) {
+                                construct(slot, take(data_[src++]));
+                            } else {
+                                construct(
+                                        slot, std::move(batch[fresh[next++]]));
+                            }
+                        });
+                this->record_moves(size_);
+                adopt_buffer(newData, newCapacity);
+                size_ = newSize;
+                refresh_prefixes();
+                return;
+            }
 
-                return true;
+            // Slots from size_ on are raw and constructed; those below hold
+            // live (possibly moved-from) elements and are assigned. If a
+            // constructor throws, the constructed tail is destroyed again.
+            size_t src = size_;
+            size_t dst = newSize;
+            try {
+                for (size_t f = fresh.size(); f > 0; --f) {
+                    auto&& incoming = batch[fresh[f - 1]];
+                    while (src > 0
+                           && compare_(incoming.first, data_[src - 1].first)) {
+                        --src;
+                        put(dst - 1, std::move(storage(data_[src])));
+                        --dst;
+                    }
+                    put(dst - 1, std::move(incoming));
+                    --dst;
+                }
+            } catch (...) {
+                for (size_t i = std::max(dst, size_); i < newSize; ++i) {
+                    destroy(&data_[i]);
+                }
+                throw;
             }
 
-            return false;
+            // The elements below src stayed in place.
+            this->record_moves(size_ - src);
+            size_ = newSize;
+            refresh_prefixes();
         }
 
-        iterator find(const key_type& key)
+        // Appends an already sorted and deduplicated range to an empty map
+        // whose capacity has been reserved up front.
+        template <typename InputIt>
+        void append_sorted(InputIt begin, InputIt end)
         {
-            auto iter = std::lower_bound(
-                    begin(),
-                    end(),
-                    key,
-                    [this](const value_type& element, const Key& key) {
-                        return compare_(element.first, key);
-                    });
+            try {
+                for (auto iter = begin; iter != end; ++iter) {
+                    construct(&data_[size_], *iter);
+                    ++size_;
+                }
+            } catch (...) {
+                release();
+                throw;
+            }
+        }
 
-            if (iter != end() && !(compare_(key, iter->first))) {
-                return iter;
+        // Constructs the element at `index` from `value` if the slot is
+        // past the end and assigns it otherwise.
+        template <class V>
+        void put(size_t index, V&& value)
+        {
+            if (index < size_) {
+                storage(data_[index]) = std::forward<V>(value);
+            } else {
+                construct(&data_[index], std::forward<V>(value));
+            }
+        }
+
+        void erase_at(size_t index, size_t count = 1)
+        {
+            if (count == 0) {
+                return;
+            }
+
+            this->record_moves(size_ - index - count);
+            for (size_t i = index + count; i < size_; ++i) {
+                storage(data_[i - count]) = std::move(storage(data_[i]));
             }
 
-            return end();
+            for (size_t i = size_ - count; i < size_; ++i) {
+                destroy(&data_[i]);
+            }
+            size_ -= count;
+            note_shift(count);
+            if constexpr (prefix_search) {
+                if (searchIndex_) {
+                    searchIndex_->erase(index, count);
+                }
+            }
         }
 
-        bool contains(const Key& key)
+        // Every element moved by at most `count` positions. The learned
+        // index widens its search by that much until the total exceeds
+        // its error bound, and is dropped then.
+        void note_shift(size_t count)
         {
-            return find(key) != end();
+            if constexpr (learned_search) {
+                if (searchIndex_ && !searchIndex_->absorb(count)) {
+                    searchIndex_.reset();
+                }
+            }
         }
 
-        size_t size() const
+        // Brings the prefix cache in step with the elements, or drops it
+        // if that fails, e.g. for lack of memory, as the elements have
+        // already changed.
+        template <class Update>
+        void update_prefixes(Update update)
         {
-            return size_;
+            try {
+                update();
+            } catch (...) {
+                searchIndex_.reset();
+            }
+        }
+
+        // Rebuilds the prefix cache, if any, after a bulk change.
+        void refresh_prefixes()
+        {
+            if constexpr (prefix_search) {
+                if (searchIndex_) {
+                    update_prefixes([this] { build_prefix_cache(); });
+                }
+            }
         }
     };
 
-    template <typename K, typename T, typename Compare>
-    std::ostream&
-    operator<<(std::ostream& stream, const FlatMap<K, T, Compare>& flatMap)
+    template <
+            typename K,
+            typename T,
+            typename Compare,
+            typename Allocator,
+            typename Stats>
+    std::ostream& operator<<(
+            std::ostream& stream,
+            const FlatMap<K, T, Compare, Allocator, Stats>& flatMap)
     {
         for (const auto& pair : flatMap) {
             stream << pair.first << ' ' << pair.second << '\n';
         }
         return stream;
     }
-}; // namespace fox
\ No newline at end of file
+}; // namespace fox
+
+namespace fox::pmr {
+
+    // A FlatMap whose buffer comes from a std::pmr::memory_resource, e.g. a
+    // per-request std::pmr::monotonic_buffer_resource.
+    template <class Key, class T, class Compare = std::less<Key>>
+    using FlatMap = fox::FlatMap<
+            Key,
+            T,
+            Compare,
+            std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+}; // namespace fox::pmr
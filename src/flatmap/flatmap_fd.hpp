@@ -0,0 +1,90 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <cerrno>
+
+#include <cstddef>
+
+#include <stdexcept>
+
+#include <system_error>
+
+#include <unistd.h>
+
+namespace fox {
+
+    namespace detail {
+
+        struct FdSink {
+            int fd;
+
+            void write(const char* data, size_t size)
+            {
+                while (size > 0) {
+                    const ssize_t written = ::write(fd, data, size);
+                    if (written < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (written < 0) {
+                        throw std::system_error(
+                                errno,
+                                std::generic_category(),
+                                "FlatMap: write failed");
+                    }
+                    data += written;
+                    size -= static_cast<size_t>(written);
+                }
+            }
+        };
+
+        struct FdSource {
+            int fd;
+
+            void read(char* data, size_t size)
+            {
+                while (size > 0) {
+                    const ssize_t got = ::read(fd, data, size);
+                    if (got < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (got < 0) {
+                        throw std::system_error(
+                                errno,
+                                std::generic_category(),
+                                "FlatMap: read failed");
+                    }
+                    if (got == 0) {
+                        throw std::runtime_error("FlatMap: truncated stream");
+                    }
+                    data += got;
+                    size -= static_cast<size_t>(got);
+                }
+            }
+        };
+
+    } // namespace detail
+
+    // FlatMap::serialize() straight to a file descriptor, without an
+    // iostream in between. POSIX only.
+    template <class Map>
+    void serialize_fd(
+            const Map& map,
+            int fd,
+            const SerializeOptions& options = SerializeOptions())
+    {
+        detail::FdSink sink{fd};
+        map.serialize_to(sink, options);
+    }
+
+    // FlatMap::deserialize() from a file descriptor.
+    template <class Map>
+    Map deserialize_fd(
+            int fd,
+            const typename Map::allocator_type& alloc =
+                    typename Map::allocator_type())
+    {
+        detail::FdSource source{fd};
+        return Map::deserialize_from(source, alloc);
+    }
+}; // namespace fox
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+
+#include <cerrno>
+
+#include <cstdint>
+
+#include <cstdio>
+
+#include <fstream>
+
+#include <iterator>
+
+#include <string>
+
+#include <system_error>
+
+#include <type_traits>
+
+namespace fox::detail {
+
+    // Binary image of a map with trivially copyable keys and values, as
+    // written by FlatMap::save() and mapped by FlatMapView. After the
+    // header come the sorted keys, the values in the same order and,
+    // optionally, a sparse index holding the first key of every page of
+    // keys. Each section starts on an image_alignment boundary so that it
+    // can be used in place from a mapping.
+    inline constexpr char image_magic[8] = {
+            'F', 'O', 'X', 'F', 'M', 'A', 'P', '\0'};
+    inline constexpr uint32_t image_version = 1;
+    // Reads back differently on a host with the other byte order.
+    inline constexpr uint32_t image_byte_order = 0x01020304;
+    inline constexpr uint64_t image_alignment = 64;
+
+    struct ImageHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t count;
+        uint32_t keySize;
+        uint32_t keyAlign;
+        uint32_t valueSize;
+        uint32_t valueAlign;
+        uint64_t keysOffset;
+        uint64_t valuesOffset;
+        uint64_t indexOffset;
+        uint64_t indexCount;
+        uint64_t indexStride;
+        uint64_t fileSize;
+    };
+
+    // Keys per index entry: one entry per 4 KiB page of keys, so a lookup
+    // touches a single key page after searching the index.
+    template <class Key>
+    inline constexpr uint64_t image_index_stride
+            = std::max<uint64_t>(1, 4096 / sizeof(Key));
+
+    inline uint64_t image_align(uint64_t offset)
+    {
+        return (offset + image_alignment - 1) / image_alignment
+                * image_alignment;
+    }
+
+    template <class Key, class T>
+    ImageHeader make_image_header(uint64_t count, bool withIndex)
+    {
+        ImageHeader header{};
+        std::copy(
+                std::begin(image_magic),
+                std::end(image_magic),
+                std::begin(header.magic));
+        header.version = image_version;
+        header.byteOrder = image_byte_order;
+        header.count = count;
+        header.keySize = sizeof(Key);
+        header.keyAlign = alignof(Key);
+        header.valueSize = sizeof(T);
+        header.valueAlign = alignof(T);
+        header.keysOffset = image_align(sizeof(ImageHeader));
+        header.valuesOffset
+                = image_align(header.keysOffset + count * sizeof(Key));
+        header.indexOffset
+                = image_align(header.valuesOffset + count * sizeof(T));
+        header.indexStride = image_index_stride<Key>;
+        header.indexCount = withIndex
+                ? (count + header.indexStride - 1) / header.indexStride
+                : 0;
+        header.fileSize
+                = header.indexOffset + header.indexCount * sizeof(Key);
+        return header;
+    }
+
+    // Writes the image of `count` sorted pairs to a temporary file and
+    // renames it over `path`, so processes mapping the previous image
+    // keep a consistent copy.
+    template <class Key, class T, class Elem>
+    void write_image(
+            const std::string& path,
+            const Elem* data,
+            uint64_t count,
+            bool withIndex)
+    {
+        static_assert(
+                std::is_trivially_copyable_v<Key>
+                        && std::is_trivially_copyable_v<T>,
+                "binary images need trivially copyable keys and values");
+        static_assert(
+                alignof(Key) <= image_alignment
+                        && alignof(T) <= image_alignment,
+                "binary images align sections to 64 bytes");
+
+        const ImageHeader header = make_image_header<Key, T>(count, withIndex);
+        const std::string temporary = path + ".tmp";
+
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::system_error(
+                    errno, std::generic_category(), "cannot create " + path);
+        }
+
+        uint64_t offset = 0;
+        auto write = [&out, &offset](const void* bytes, uint64_t size) {
+            out.write(
+                    static_cast<const char*>(bytes),
+                    static_cast<std::streamsize>(size));
+            offset += size;
+        };
+        auto pad_to = [&out, &offset](uint64_t target) {
+            for (; offset < target; ++offset) {
+                out.put('\0');
+            }
+        };
+
+        write(&header, sizeof(header));
+        pad_to(header.keysOffset);
+        for (uint64_t i = 0; i < count; ++i) {
+            write(&data[i].first, sizeof(Key));
+        }
+        pad_to(header.valuesOffset);
+        for (uint64_t i = 0; i < count; ++i) {
+            write(&data[i].second, sizeof(T));
+        }
+        pad_to(header.indexOffset);
+        for (uint64_t i = 0; i < header.indexCount; ++i) {
+            write(&data[i * header.indexStride].first, sizeof(Key));
+        }
+
+        out.close();
+        if (!out) {
+            std::remove(temporary.c_str());
+            throw std::system_error(
+                    EIO, std::generic_category(), "cannot write " + path);
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            const int error = errno;
+            std::remove(temporary.c_str());
+            throw std::system_error(
+                    error, std::generic_category(), "cannot replace " + path);
+        }
+    }
+}; // namespace fox::detail
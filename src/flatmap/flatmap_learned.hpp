@@ -0,0 +1,150 @@
+#pragma once
+
+#include <flatmap_search.hpp>
+
+#include <algorithm>
+
+#include <cstddef>
+
+#include <limits>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox::detail {
+
+    // Arithmetic keys in their natural order, which a linear model of
+    // key to position can follow.
+    template <class Key, class Compare>
+    inline constexpr bool use_learned_index
+            = use_branchless_search<Key, Compare>;
+
+    // Piecewise-linear model of where each key sits in a sorted array, in
+    // the style of a PGM index: every segment predicts the positions of
+    // its keys to within `epsilon`. The segments are fitted in one pass
+    // with the shrinking-cone algorithm, which grows a segment while some
+    // slope through its first point stays within `epsilon` of every
+    // point seen so far.
+    template <class Key>
+    class LearnedIndex {
+    private:
+        struct Segment {
+            double slope;
+            size_t start;
+        };
+
+        // Kept apart from the segments so that finding a segment reads a
+        // dense key array.
+        std::vector<Key> firstKeys_;
+        std::vector<Segment> segments_;
+        size_t size_ = 0;
+        size_t epsilon_ = 0;
+        // Total positions elements may have moved since the fit.
+        size_t drift_ = 0;
+
+    public:
+        template <class Elem, class Proj>
+        LearnedIndex(const Elem* data, size_t size, size_t epsilon, Proj proj)
+            : size_(size), epsilon_(epsilon)
+        {
+            const auto bound = static_cast<double>(epsilon);
+            size_t first = 0;
+            while (first < size) {
+                const Key origin = proj(data[first]);
+                double low = 0;
+                double high = std::numeric_limits<double>::infinity();
+
+                size_t next = first + 1;
+                for (; next < size; ++next) {
+                    const double dx = distance(origin, proj(data[next]));
+                    const auto dy = static_cast<double>(next - first);
+                    const double newLow = std::max(low, (dy - bound) / dx);
+                    const double newHigh = std::min(high, (dy + bound) / dx);
+                    if (newLow > newHigh) {
+                        break;
+                    }
+                    low = newLow;
+                    high = newHigh;
+                }
+
+                firstKeys_.push_back(origin);
+                segments_.push_back(
+                        {next == first + 1 ? 0.0 : (low + high) / 2, first});
+                first = next;
+            }
+            firstKeys_.shrink_to_fit();
+            segments_.shrink_to_fit();
+        }
+
+        size_t segments() const
+        {
+            return segments_.size();
+        }
+
+        size_t bytes() const
+        {
+            return sizeof(*this) + firstKeys_.capacity() * sizeof(Key)
+                    + segments_.capacity() * sizeof(Segment);
+        }
+
+        // Accounts for inserts or erases that moved elements by up to
+        // `count` positions. Returns false once the drift exceeds epsilon
+        // and the model is no longer worth keeping.
+        bool absorb(size_t count)
+        {
+            drift_ += count;
+            return drift_ <= epsilon_;
+        }
+
+        // Positions [first, last) of a map of `size` elements that contain
+        // the lower bound of `key`.
+        std::pair<size_t, size_t> window(Key key, size_t size) const
+        {
+            const size_t found = lower_bound_index(
+                    firstKeys_.data(), firstKeys_.size(), key);
+            // The segment of `key` is the last one starting at or below it.
+            const size_t segment = found < firstKeys_.size()
+                            && !(key < firstKeys_[found])
+                    ? found
+                    : std::max<size_t>(found, 1) - 1;
+
+            const Segment& model = segments_[segment];
+            const size_t end = segment + 1 < segments_.size()
+                    ? segments_[segment + 1].start
+                    : size_;
+            // Keys between two segments belong to the start of the next,
+            // so clamping to the segment bounds keeps them in reach.
+            const double predicted = static_cast<double>(model.start)
+                    + model.slope * distance(firstKeys_[segment], key);
+            const double clamped = std::clamp(
+                    predicted,
+                    static_cast<double>(model.start),
+                    static_cast<double>(end));
+
+            // One more for keys between two predicted positions.
+            const size_t reach = epsilon_ + drift_ + 1;
+            const auto position = static_cast<size_t>(clamped);
+            const size_t last = std::min(position + reach + 1, size);
+            return {std::min(position > reach ? position - reach : 0, last),
+                    last};
+        }
+
+    private:
+        // to - from as a double, without overflowing integer keys.
+        static double distance(Key from, Key to)
+        {
+            if constexpr (std::is_integral_v<Key>) {
+                using Unsigned = std::make_unsigned_t<Key>;
+                const auto low = static_cast<Unsigned>(from);
+                const auto high = static_cast<Unsigned>(to);
+                return from <= to ? static_cast<double>(high - low)
+                                  : -static_cast<double>(low - high);
+            } else {
+                return static_cast<double>(to) - static_cast<double>(from);
+            }
+        }
+    };
+}; // namespace fox::detail
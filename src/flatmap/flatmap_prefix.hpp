@@ -0,0 +1,151 @@
+#pragma once
+
+#include <flatmap_search.hpp>
+
+#include <algorithm>
+
+#include <cstddef>
+
+#include <cstdint>
+
+#include <functional>
+
+#include <string>
+
+#include <string_view>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // Maps a key to 64 bits whose unsigned order never contradicts the
+    // key order: a < b implies key_prefix(a) <= key_prefix(b). FlatMap's
+    // prefix cache then decides a comparison from the prefixes alone
+    // when they differ. Specialize it for composite keys, e.g. by
+    // packing the prefixes of the leading members high bits first; the
+    // order it encodes must agree with the map's Compare.
+    template <class Key, class = void>
+    struct key_prefix;
+
+    // Whether key_prefix<Key> agrees with the order of Compare, which
+    // build_prefix_cache() checks. It holds for std::less; specialize it
+    // as true for other comparators that order keys the same way.
+    template <class Key, class Compare>
+    struct key_prefix_agrees
+        : std::bool_constant<
+                  std::is_same_v<Compare, std::less<Key>>
+                  || std::is_same_v<Compare, std::less<>>> {};
+
+    // The first eight bytes, big-endian and zero padded, so that integer
+    // order is the order of the unsigned bytes std::string compares.
+    template <>
+    struct key_prefix<std::string_view> {
+        uint64_t operator()(std::string_view key) const
+        {
+            unsigned char bytes[8] = {};
+            std::copy_n(key.data(), std::min<size_t>(key.size(), 8), bytes);
+            uint64_t prefix = 0;
+            for (const unsigned char byte : bytes) {
+                prefix = (prefix << 8U) | byte;
+            }
+            return prefix;
+        }
+    };
+
+    template <>
+    struct key_prefix<std::string> : key_prefix<std::string_view> {};
+
+    // Integers with the sign bit flipped, for building composite
+    // prefixes; FlatMap searches integer keys directly.
+    template <class Key>
+    struct key_prefix<Key, std::enable_if_t<std::is_integral_v<Key>>> {
+        uint64_t operator()(Key key) const
+        {
+            if constexpr (std::is_signed_v<Key>) {
+                return static_cast<uint64_t>(static_cast<int64_t>(key))
+                        ^ (uint64_t{1} << 63U);
+            } else {
+                return static_cast<uint64_t>(key);
+            }
+        }
+    };
+
+    namespace detail {
+
+        // Whether key_prefix<Key> is defined and accepts a `K`.
+        template <class Key, class K, class = void>
+        inline constexpr bool has_key_prefix = false;
+
+        template <class Key, class K>
+        inline constexpr bool has_key_prefix<
+                Key,
+                K,
+                std::void_t<decltype(key_prefix<Key>()(
+                        std::declval<const K&>()))>> = true;
+
+        // key_prefix of every key of a map, kept in step with its
+        // elements.
+        template <class Key>
+        class PrefixCache {
+        private:
+            std::vector<uint64_t> prefixes_;
+
+        public:
+            template <class Elem, class Proj>
+            PrefixCache(const Elem* data, size_t size, Proj proj)
+            {
+                prefixes_.reserve(size);
+                for (size_t i = 0; i < size; ++i) {
+                    prefixes_.push_back(key_prefix<Key>()(proj(data[i])));
+                }
+            }
+
+            size_t bytes() const
+            {
+                return sizeof(*this)
+                        + prefixes_.capacity() * sizeof(uint64_t);
+            }
+
+            void insert(size_t index, const Key& key)
+            {
+                prefixes_.insert(
+                        prefixes_.begin() + static_cast<std::ptrdiff_t>(index),
+                        key_prefix<Key>()(key));
+            }
+
+            void erase(size_t index, size_t count)
+            {
+                const auto first = prefixes_.begin()
+                        + static_cast<std::ptrdiff_t>(index);
+                prefixes_.erase(
+                        first, first + static_cast<std::ptrdiff_t>(count));
+            }
+
+            // Positions [first, last) around the elements whose prefix
+            // equals that of `key`. Elements before them compare below
+            // `key` and elements from `last` on above it, so both its
+            // lower and its upper bound lie in [first, last].
+            template <class K>
+            std::pair<size_t, size_t> window(const K& key) const
+            {
+                const uint64_t probe = key_prefix<Key>()(key);
+                const uint64_t* data = prefixes_.data();
+                const size_t size = prefixes_.size();
+                const size_t first = lower_bound_index(data, size, probe);
+
+                // Gallop past the run of equal prefixes, which is short
+                // or empty unless many keys share their first bytes.
+                size_t last = first;
+                for (size_t step = 1; last < size && data[last] == probe;
+                     step *= 2) {
+                    last = std::min(last + step, size);
+                }
+                return {first, last};
+            }
+        };
+    }; // namespace detail
+}; // namespace fox
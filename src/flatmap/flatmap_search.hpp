@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+
+#include <cstddef>
+
+#include <cstdint>
+
+#include <functional>
+
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace fox::detail {
+
+    template <class Compare, class = void>
+    struct is_transparent : std::false_type {};
+
+    template <class Compare>
+    struct is_transparent<
+            Compare,
+            std::void_t<typename Compare::is_transparent>> : std::true_type {};
+
+    template <class Compare>
+    inline constexpr bool is_transparent_v = is_transparent<Compare>::value;
+
+    // Enables the heterogeneous lookup overloads for comparators that
+    // declare is_transparent, as the standard associative containers do.
+    template <class Compare>
+    using enable_if_transparent
+            = std::enable_if_t<is_transparent_v<Compare>, int>;
+
+    // Arithmetic keys ordered by std::less can use the branchless search
+    // below instead of std::lower_bound with a comparator lambda.
+    template <class Key, class Compare>
+    inline constexpr bool use_branchless_search = std::is_arithmetic_v<Key>
+            && !std::is_same_v<Key, bool>
+            && (std::is_same_v<Compare, std::less<Key>>
+                || std::is_same_v<Compare, std::less<>>);
+
+    // Number of trailing elements scanned linearly once the binary search
+    // has narrowed the range: about four cache lines, between 1 and 64.
+    template <class Elem>
+    inline constexpr size_t linear_window
+            = std::clamp<size_t>(256 / sizeof(Elem), 1, 64);
+
+    // Hints the CPU to pull the cache line at `address` for a read.
+    inline void prefetch(const void* address)
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(address, 0, 3);
+#else
+        (void)address;
+#endif
+    }
+
+    // `value` must have at least one zero bit.
+    inline size_t trailing_ones(size_t value)
+    {
+#if defined(__GNUC__)
+        return static_cast<size_t>(__builtin_ctzll(~value));
+#else
+        size_t count = 0;
+        for (; (value & 1U) != 0; value >>= 1U) {
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    // Index of the highest set bit; `value` must not be zero.
+    inline size_t log2_floor(size_t value)
+    {
+#if defined(__GNUC__)
+        return static_cast<size_t>(63 - __builtin_clzll(value));
+#else
+        size_t result = 0;
+        while (value >>= 1U) {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    template <class Key>
+    size_t count_less(const Key* keys, size_t size, Key key)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < size; ++i) {
+            count += static_cast<size_t>(keys[i] < key);
+        }
+        return count;
+    }
+
+#if defined(__AVX2__)
+    inline size_t sum_lanes(__m256i acc, size_t lanes)
+    {
+        alignas(32) int64_t parts[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(parts), acc);
+        if (lanes == 4) {
+            return static_cast<size_t>(
+                    parts[0] + parts[1] + parts[2] + parts[3]);
+        }
+
+        // Eight 32-bit counters packed into four 64-bit parts.
+        size_t count = 0;
+        for (const int64_t part : parts) {
+            const auto bits = static_cast<uint64_t>(part);
+            count += (bits & 0xFFFFFFFFU) + (bits >> 32U);
+        }
+        return count;
+    }
+
+    inline size_t count_less(const int64_t* keys, size_t size, int64_t key)
+    {
+        const __m256i needle = _mm256_set1_epi64x(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            const __m256i block = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(keys + i));
+            acc = _mm256_sub_epi64(acc, _mm256_cmpgt_epi64(needle, block));
+        }
+        return sum_lanes(acc, 4) + count_less<int64_t>(keys + i, size - i, key);
+    }
+
+    inline size_t count_less(const uint64_t* keys, size_t size, uint64_t key)
+    {
+        const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        const __m256i needle = _mm256_xor_si256(
+                _mm256_set1_epi64x(static_cast<int64_t>(key)), sign);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            const __m256i block = _mm256_xor_si256(
+                    _mm256_loadu_si256(
+                            reinterpret_cast<const __m256i*>(keys + i)),
+                    sign);
+            acc = _mm256_sub_epi64(acc, _mm256_cmpgt_epi64(needle, block));
+        }
+        return sum_lanes(acc, 4)
+                + count_less<uint64_t>(keys + i, size - i, key);
+    }
+
+    inline size_t count_less(const int32_t* keys, size_t size, int32_t key)
+    {
+        const __m256i needle = _mm256_set1_epi32(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            const __m256i block = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(keys + i));
+            acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(needle, block));
+        }
+        return sum_lanes(acc, 8) + count_less<int32_t>(keys + i, size - i, key);
+    }
+
+    inline size_t count_less(const uint32_t* keys, size_t size, uint32_t key)
+    {
+        const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+        const __m256i needle = _mm256_xor_si256(
+                _mm256_set1_epi32(static_cast<int32_t>(key)), sign);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            const __m256i block = _mm256_xor_si256(
+                    _mm256_loadu_si256(
+                            reinterpret_cast<const __m256i*>(keys + i)),
+                    sign);
+            acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(needle, block));
+        }
+        return sum_lanes(acc, 8)
+                + count_less<uint32_t>(keys + i, size - i, key);
+    }
+
+    inline size_t count_less(const double* keys, size_t size, double key)
+    {
+        const __m256d needle = _mm256_set1_pd(key);
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            const __m256d block = _mm256_loadu_pd(keys + i);
+            acc = _mm256_sub_epi64(
+                    acc,
+                    _mm256_castpd_si256(
+                            _mm256_cmp_pd(block, needle, _CMP_LT_OQ)));
+        }
+        return sum_lanes(acc, 4) + count_less<double>(keys + i, size - i, key);
+    }
+#elif defined(__SSE4_2__)
+    inline size_t count_less(const int64_t* keys, size_t size, int64_t key)
+    {
+        const __m128i needle = _mm_set1_epi64x(key);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= size; i += 2) {
+            const __m128i block = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(keys + i));
+            acc = _mm_sub_epi64(acc, _mm_cmpgt_epi64(needle, block));
+        }
+        const auto count = static_cast<size_t>(
+                _mm_cvtsi128_si64(acc)
+                + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+        return count + count_less<int64_t>(keys + i, size - i, key);
+    }
+
+    inline size_t count_less(const uint64_t* keys, size_t size, uint64_t key)
+    {
+        const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+        const __m128i needle = _mm_xor_si128(
+                _mm_set1_epi64x(static_cast<int64_t>(key)), sign);
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= size; i += 2) {
+            const __m128i block = _mm_xor_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)),
+                    sign);
+            acc = _mm_sub_epi64(acc, _mm_cmpgt_epi64(needle, block));
+        }
+        const auto count = static_cast<size_t>(
+                _mm_cvtsi128_si64(acc)
+                + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+        return count + count_less<uint64_t>(keys + i, size - i, key);
+    }
+#endif
+
+    // Branchless lower bound over `size` elements whose keys are read
+    // through `proj`. The halving loop compiles to conditional moves and
+    // the final window is counted without branches.
+    template <class Elem, class Key, class Proj>
+    size_t lower_bound_index(
+            const Elem* data, size_t size, const Key& key, Proj proj)
+    {
+        const Elem* base = data;
+        size_t len = size;
+        while (len > linear_window<Elem>) {
+            const size_t half = len / 2;
+            base = (proj(base[half]) < key) ? base + half : base;
+            len -= half;
+        }
+
+        size_t count = 0;
+        for (size_t i = 0; i < len; ++i) {
+            count += static_cast<size_t>(proj(base[i]) < key);
+        }
+        return static_cast<size_t>(base - data) + count;
+    }
+
+    // Same search over a contiguous key array; the final window goes
+    // through the SIMD count_less overloads when they are available.
+    template <class Key>
+    size_t lower_bound_index(const Key* keys, size_t size, Key key)
+    {
+        const Key* base = keys;
+        size_t len = size;
+        while (len > linear_window<Key>) {
+            const size_t half = len / 2;
+            base = (base[half] < key) ? base + half : base;
+            len -= half;
+        }
+
+        return static_cast<size_t>(base - keys) + count_less(base, len, key);
+    }
+
+    // Keys searched together by lower_bound_batch(): enough independent
+    // loads to keep the core's line fill buffers busy.
+    inline constexpr size_t batch_group = 16;
+
+    // Lower bounds of up to batch_group keys at once. The searches run in
+    // lockstep, and each step prefetches the next probe of every key
+    // before any of them is compared, so the cache misses of different
+    // keys overlap instead of forming one dependent chain per key.
+    template <class Elem, class Key, class Less>
+    void lower_bound_batch(
+            const Elem* data,
+            size_t size,
+            const Key* const* keys,
+            size_t count,
+            size_t* out,
+            Less less)
+    {
+        std::fill(out, out + count, size_t{0});
+        if (size == 0) {
+            return;
+        }
+
+        size_t len = size;
+        while (len > 1) {
+            const size_t half = len / 2;
+            len -= half;
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = less(data[out[i] + half], *keys[i])
+                        ? out[i] + half
+                        : out[i];
+                prefetch(data + out[i] + len / 2);
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            out[i] += static_cast<size_t>(less(data[out[i]], *keys[i]));
+        }
+    }
+}; // namespace fox::detail
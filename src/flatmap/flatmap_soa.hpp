@@ -0,0 +1,603 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <flatmap_search.hpp>
+
+#include <iterator>
+
+#include <iostream>
+
+#include <stdexcept>
+
+#include <algorithm>
+
+#include <initializer_list>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A sorted map that keeps keys and mapped values in two separate
+    // contiguous containers, like std::flat_map. Lookups only touch the key
+    // container, so large mapped values never pollute the cache during a
+    // binary search.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class KeyContainer = std::vector<Key>,
+            class MappedContainer = std::vector<T>>
+    class FlatMapSoA {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<key_type, mapped_type>;
+        using key_compare = Compare;
+        using reference = std::pair<const key_type&, mapped_type&>;
+        using const_reference
+                = std::pair<const key_type&, const mapped_type&>;
+        using size_type = size_t;
+        using key_container_type = KeyContainer;
+        using mapped_container_type = MappedContainer;
+
+        struct containers {
+            key_container_type keys;
+            mapped_container_type values;
+        };
+
+    private:
+        key_container_type keys_;
+        mapped_container_type values_;
+        Compare compare_;
+
+    public:
+        template <class K, class V>
+        class Iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::pair<Key, T>;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::pair<K&, V&>;
+
+            struct pointer {
+                reference pair;
+
+                reference* operator->()
+                {
+                    return &pair;
+                }
+            };
+
+            Iterator(K* key, V* value) : key_(key), value_(value)
+            {
+            }
+
+            reference operator*() const
+            {
+                return reference(*key_, *value_);
+            }
+
+            pointer operator->() const
+            {
+                return pointer{reference(*key_, *value_)};
+            }
+
+            Iterator& operator++()
+            {
+                ++key_;
+                ++value_;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator oldValue = *this;
+                ++(*this);
+                return oldValue;
+            }
+
+            Iterator& operator--()
+            {
+                --key_;
+                --value_;
+                return *this;
+            }
+
+            Iterator operator--(int)
+            {
+                Iterator oldValue = *this;
+                --(*this);
+                return oldValue;
+            }
+
+            Iterator operator+(difference_type n) const
+            {
+                return Iterator(key_ + n, value_ + n);
+            }
+
+            Iterator operator-(difference_type n) const
+            {
+                return Iterator(key_ - n, value_ - n);
+            }
+
+            difference_type operator-(Iterator other) const
+            {
+                return key_ - other.key_;
+            }
+
+            Iterator& operator+=(difference_type n)
+            {
+                key_ += n;
+                value_ += n;
+                return *this;
+            }
+
+            Iterator& operator-=(difference_type n)
+            {
+                key_ -= n;
+                value_ -= n;
+                return *this;
+            }
+
+            reference operator[](difference_type n) const
+            {
+                return *(*this + n);
+            }
+
+            friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+            {
+                return (lhs.key_ == rhs.key_);
+            }
+
+            friend bool operator!=(const Iterator& lhs, const Iterator& rhs)
+            {
+                return (lhs.key_ != rhs.key_);
+            }
+
+            friend bool operator<(const Iterator& lhs, const Iterator& rhs)
+            {
+                return (lhs.key_ < rhs.key_);
+            }
+            friend bool operator>(const Iterator& lhs, const Iterator& rhs)
+            {
+                return (lhs.key_ > rhs.key_);
+            }
+            friend bool operator<=(const Iterator& lhs, const Iterator& rhs)
+            {
+                return (lhs.key_ <= rhs.key_);
+            }
+            friend bool operator>=(const Iterator& lhs, const Iterator& rhs)
+            {
+                return (lhs.key_ >= rhs.key_);
+            }
+
+        private:
+            K* key_ = nullptr;
+            V* value_ = nullptr;
+        };
+
+        using iterator = Iterator<const key_type, mapped_type>;
+        using const_iterator = Iterator<const key_type, const mapped_type>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        FlatMapSoA() = default;
+
+        FlatMapSoA(size_t capacity)
+        {
+            reserve(capacity);
+        }
+
+        template <typename InputIt>
+        FlatMapSoA(InputIt begin, InputIt end)
+        {
+            std::vector<value_type> staging(begin, end);
+
+            std::stable_sort(
+                    staging.begin(),
+                    staging.end(),
+                    [this](const auto& lhs, const auto& rhs) {
+                        return compare_(lhs.first, rhs.first);
+                    });
+
+            // Keeps the first occurrence of each key, like FlatMap.
+            auto last = std::unique(
+                    staging.begin(),
+                    staging.end(),
+                    [this](const auto& lhs, const auto& rhs) {
+                        return !compare_(lhs.first, rhs.first)
+                                && !compare_(rhs.first, lhs.first);
+                    });
+
+            reserve(static_cast<size_t>(last - staging.begin()));
+            for (auto iter = staging.begin(); iter != last; ++iter) {
+                keys_.push_back(std::move(iter->first));
+                values_.push_back(std::move(iter->second));
+            }
+        }
+
+        FlatMapSoA(std::initializer_list<value_type> list)
+            : FlatMapSoA(list.begin(), list.end())
+        {
+        }
+
+        template <typename InputIt>
+        FlatMapSoA(sorted_unique_t /*unused*/, InputIt begin, InputIt end)
+        {
+            reserve(std::distance(begin, end));
+            for (auto iter = begin; iter != end; ++iter) {
+                keys_.push_back(iter->first);
+                values_.push_back(iter->second);
+            }
+        }
+
+        FlatMapSoA(
+                sorted_unique_t /*unused*/,
+                key_container_type keys,
+                mapped_container_type values)
+        {
+            replace(std::move(keys), std::move(values));
+        }
+
+        iterator begin()
+        {
+            return iterator(keys_.data(), values_.data());
+        }
+        iterator end()
+        {
+            return begin() + static_cast<std::ptrdiff_t>(size());
+        }
+        const_iterator begin() const
+        {
+            return const_iterator(keys_.data(), values_.data());
+        }
+        const_iterator end() const
+        {
+            return begin() + static_cast<std::ptrdiff_t>(size());
+        }
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        reverse_iterator rbegin()
+        {
+            return reverse_iterator(end());
+        }
+        reverse_iterator rend()
+        {
+            return reverse_iterator(begin());
+        }
+        const_reverse_iterator crbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+        const_reverse_iterator crend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        const key_container_type& keys() const
+        {
+            return keys_;
+        }
+
+        const mapped_container_type& values() const
+        {
+            return values_;
+        }
+
+        // Moves both containers out and leaves the map empty.
+        containers extract() &&
+        {
+            containers result{std::move(keys_), std::move(values_)};
+            keys_.clear();
+            values_.clear();
+            return result;
+        }
+
+        // Adopts containers that are already sorted by the map's comparator
+        // and free of duplicate keys.
+        void replace(key_container_type&& keys, mapped_container_type&& values)
+        {
+            if (keys.size() != values.size()) {
+                throw std::invalid_argument(
+                        "Key and value containers differ in size");
+            }
+
+            keys_ = std::move(keys);
+            values_ = std::move(values);
+        }
+
+        T& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& operator[](Key&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        mapped_type& at(const key_type& key)
+        {
+            return values_[at_index(key)];
+        }
+
+        const mapped_type& at(const key_type& key) const
+        {
+            return values_[at_index(key)];
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        mapped_type& at(const K& key)
+        {
+            return values_[at_index(key)];
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const mapped_type& at(const K& key) const
+        {
+            return values_[at_index(key)];
+        }
+
+        bool empty() const
+        {
+            return keys_.empty();
+        }
+
+        std::pair<iterator, bool> insert(const Key& key, const T& value)
+        {
+            return try_emplace(key, value);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(
+                    std::move(value.first), std::move(value.second));
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            return try_emplace_impl(key, std::forward<Args>(args)...);
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            return try_emplace_impl(
+                    std::move(key), std::forward<Args>(args)...);
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value)
+        {
+            return insert_or_assign_impl(key, std::forward<M>(value));
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value)
+        {
+            return insert_or_assign_impl(
+                    std::move(key), std::forward<M>(value));
+        }
+
+        bool erase(const Key& key)
+        {
+            return erase_impl(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0,
+                std::enable_if_t<!std::is_convertible_v<K, iterator>, int> = 0>
+        bool erase(const K& key)
+        {
+            return erase_impl(key);
+        }
+
+        iterator find(const key_type& key)
+        {
+            return begin() + static_cast<std::ptrdiff_t>(find_index(key));
+        }
+
+        const_iterator find(const key_type& key) const
+        {
+            return begin() + static_cast<std::ptrdiff_t>(find_index(key));
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        iterator find(const K& key)
+        {
+            return begin() + static_cast<std::ptrdiff_t>(find_index(key));
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const_iterator find(const K& key) const
+        {
+            return begin() + static_cast<std::ptrdiff_t>(find_index(key));
+        }
+
+        bool contains(const Key& key) const
+        {
+            return find_index(key) != size();
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        bool contains(const K& key) const
+        {
+            return find_index(key) != size();
+        }
+
+        size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        size_t count(const K& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        size_t size() const
+        {
+            return keys_.size();
+        }
+
+        size_t capacity() const
+        {
+            return keys_.capacity();
+        }
+
+        void reserve(size_t capacity)
+        {
+            keys_.reserve(capacity);
+            values_.reserve(capacity);
+        }
+
+        void shrink_to_fit()
+        {
+            keys_.shrink_to_fit();
+            values_.shrink_to_fit();
+        }
+
+    private:
+        template <class K>
+        size_t lower_bound_index(const K& key) const
+        {
+            if constexpr (
+                    detail::use_branchless_search<Key, Compare>
+                    && std::is_same_v<K, Key>
+                    && std::is_same_v<KeyContainer, std::vector<Key>>) {
+                return detail::lower_bound_index(keys_.data(), size(), key);
+            }
+
+            return static_cast<size_t>(
+                    std::lower_bound(keys_.begin(), keys_.end(), key, compare_)
+                    - keys_.begin());
+        }
+
+        template <class K>
+        size_t find_index(const K& key) const
+        {
+            const size_t index = lower_bound_index(key);
+
+            if (index != size() && !(compare_(key, keys_[index]))) {
+                return index;
+            }
+
+            return size();
+        }
+
+        template <class K>
+        size_t at_index(const K& key) const
+        {
+            const size_t index = find_index(key);
+
+            if (index != size()) {
+                return index;
+            }
+
+            throw std::out_of_range("Key not found in flatmap");
+        }
+
+        template <class K>
+        bool erase_impl(const K& key)
+        {
+            const size_t index = find_index(key);
+
+            if (index != size()) {
+                const auto offset = static_cast<std::ptrdiff_t>(index);
+                keys_.erase(keys_.begin() + offset);
+                values_.erase(values_.begin() + offset);
+                return true;
+            }
+
+            return false;
+        }
+
+        template <class K, class... Args>
+        std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args)
+        {
+            const size_t index = lower_bound_index(key);
+            const auto offset = static_cast<std::ptrdiff_t>(index);
+
+            if (index != size() && !(compare_(key, keys_[index]))) {
+                return {begin() + offset, false};
+            }
+
+            keys_.emplace(keys_.begin() + offset, std::forward<K>(key));
+            try {
+                values_.emplace(
+                        values_.begin() + offset, std::forward<Args>(args)...);
+            } catch (...) {
+                keys_.erase(keys_.begin() + offset);
+                throw;
+            }
+            return {begin() + offset, true};
+        }
+
+        template <class K, class M>
+        std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& value)
+        {
+            auto result = try_emplace_impl(
+                    std::forward<K>(key), std::forward<M>(value));
+            if (!result.second) {
+                result.first->second = std::forward<M>(value);
+            }
+            return result;
+        }
+    };
+
+    template <
+            typename K,
+            typename T,
+            typename Compare,
+            typename KeyContainer,
+            typename MappedContainer>
+    std::ostream& operator<<(
+            std::ostream& stream,
+            const FlatMapSoA<K, T, Compare, KeyContainer, MappedContainer>&
+                    flatMap)
+    {
+        for (const auto& pair : flatMap) {
+            stream << pair.first << ' ' << pair.second << '\n';
+        }
+        return stream;
+    }
+}; // namespace fox
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+
+#include <atomic>
+
+#include <cstddef>
+
+#include <cstdint>
+
+namespace fox {
+
+    // Counters of the work a FlatMap did, as returned by
+    // FlatMapStats::snapshot().
+    struct FlatMapStatsSnapshot {
+        // find(), contains(), count(), at() and find_batch() calls.
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Binary searches, including those of inserts and erases, and the
+        // key comparisons they made.
+        uint64_t searches = 0;
+        uint64_t comparisons = 0;
+        // Buffers allocated, the first one included, and their bytes.
+        uint64_t reallocations = 0;
+        uint64_t bytesAllocated = 0;
+        // Elements relocated by shifting, compaction and reallocation.
+        uint64_t movedElements = 0;
+        uint64_t peakCapacity = 0;
+
+        double comparisons_per_search() const
+        {
+            return searches == 0 ? 0.0
+                                 : static_cast<double>(comparisons)
+                            / static_cast<double>(searches);
+        }
+    };
+
+    // The default Stats policy of FlatMap. Every hook is empty, so the
+    // instrumentation compiles away and, as an empty base, takes no space.
+    //
+    // A Stats policy is default constructible and provides the const
+    // hooks below; FlatMap calls them from const member functions too.
+    struct NoStats {
+        void record_lookup(bool /*hit*/) const
+        {
+        }
+
+        void record_search(size_t /*comparisons*/) const
+        {
+        }
+
+        void record_moves(size_t /*count*/) const
+        {
+        }
+
+        void record_allocation(size_t /*capacity*/, size_t /*bytes*/) const
+        {
+        }
+
+        FlatMapStatsSnapshot snapshot() const
+        {
+            return {};
+        }
+
+        void reset()
+        {
+        }
+    };
+
+    // Counts with relaxed atomics, so readers sharing a map, e.g. through
+    // ConcurrentFlatMap, can update the counters of their lookups. Each
+    // FlatMap starts with zeroed counters; copies and moves do not carry
+    // them over.
+    class FlatMapStats {
+    private:
+        mutable std::atomic<uint64_t> lookups_{0};
+        mutable std::atomic<uint64_t> hits_{0};
+        mutable std::atomic<uint64_t> searches_{0};
+        mutable std::atomic<uint64_t> comparisons_{0};
+        mutable std::atomic<uint64_t> reallocations_{0};
+        mutable std::atomic<uint64_t> bytesAllocated_{0};
+        mutable std::atomic<uint64_t> movedElements_{0};
+        mutable std::atomic<uint64_t> peakCapacity_{0};
+
+    public:
+        void record_lookup(bool hit) const
+        {
+            add(lookups_, 1);
+            add(hits_, hit ? 1 : 0);
+        }
+
+        void record_search(size_t comparisons) const
+        {
+            add(searches_, 1);
+            add(comparisons_, comparisons);
+        }
+
+        void record_moves(size_t count) const
+        {
+            add(movedElements_, count);
+        }
+
+        void record_allocation(size_t capacity, size_t bytes) const
+        {
+            add(reallocations_, 1);
+            add(bytesAllocated_, bytes);
+
+            uint64_t peak = peakCapacity_.load(std::memory_order_relaxed);
+            while (peak < capacity
+                   && !peakCapacity_.compare_exchange_weak(
+                           peak, capacity, std::memory_order_relaxed)) {
+            }
+        }
+
+        // The counters are read one at a time, so a snapshot taken while
+        // other threads record is not a single point in time.
+        FlatMapStatsSnapshot snapshot() const
+        {
+            FlatMapStatsSnapshot result;
+            result.lookups = load(lookups_);
+            result.hits = std::min(load(hits_), result.lookups);
+            result.misses = result.lookups - result.hits;
+            result.searches = load(searches_);
+            result.comparisons = load(comparisons_);
+            result.reallocations = load(reallocations_);
+            result.bytesAllocated = load(bytesAllocated_);
+            result.movedElements = load(movedElements_);
+            result.peakCapacity = load(peakCapacity_);
+            return result;
+        }
+
+        void reset()
+        {
+            for (auto* counter :
+                 {&lookups_,
+                  &hits_,
+                  &searches_,
+                  &comparisons_,
+                  &reallocations_,
+                  &bytesAllocated_,
+                  &movedElements_,
+                  &peakCapacity_}) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        static void add(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        static uint64_t load(const std::atomic<uint64_t>& counter)
+        {
+            return counter.load(std::memory_order_relaxed);
+        }
+    };
+}; // namespace fox
@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+
+#include <array>
+
+#include <cerrno>
+
+#include <cstdint>
+
+#include <cstring>
+
+#include <istream>
+
+#include <ostream>
+
+#include <stdexcept>
+
+#include <string>
+
+#include <system_error>
+
+#include <type_traits>
+
+#include <vector>
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace fox {
+
+    // Settings for FlatMap::serialize(). Elements are grouped into blocks
+    // of about `blockSize` encoded bytes, so neither side buffers more
+    // than one block; with `checksum` every block carries a CRC-32C.
+    struct SerializeOptions {
+        bool checksum = true;
+        size_t blockSize = size_t{64} << 10U;
+    };
+
+    // Appends encoded values to the current block.
+    class BinaryWriter {
+    public:
+        void write(const void* bytes, size_t size)
+        {
+            const auto* first = static_cast<const char*>(bytes);
+            buffer_.insert(buffer_.end(), first, first + size);
+        }
+
+        // LEB128: seven bits per byte, low bits first.
+        void write_varint(uint64_t value)
+        {
+            while (value >= 0x80U) {
+                buffer_.push_back(static_cast<char>(value | 0x80U));
+                value >>= 7U;
+            }
+            buffer_.push_back(static_cast<char>(value));
+        }
+
+        size_t size() const
+        {
+            return buffer_.size();
+        }
+
+        const char* data() const
+        {
+            return buffer_.data();
+        }
+
+        void clear()
+        {
+            buffer_.clear();
+        }
+
+    private:
+        std::vector<char> buffer_;
+    };
+
+    // Reads encoded values back from a block; throws std::runtime_error
+    // when a value runs past the end of the block.
+    class BinaryReader {
+    public:
+        BinaryReader(const char* begin, const char* end)
+            : next_(begin), end_(end)
+        {
+        }
+
+        void read(void* bytes, size_t size)
+        {
+            if (remaining() < size) {
+                throw std::runtime_error("FlatMap: truncated block");
+            }
+            std::memcpy(bytes, next_, size);
+            next_ += size;
+        }
+
+        uint64_t read_varint()
+        {
+            uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                unsigned char byte = 0;
+                read(&byte, 1);
+                value |= static_cast<uint64_t>(byte & 0x7FU) << shift;
+                if ((byte & 0x80U) == 0) {
+                    return value;
+                }
+            }
+            throw std::runtime_error("FlatMap: malformed varint");
+        }
+
+        size_t remaining() const
+        {
+            return static_cast<size_t>(end_ - next_);
+        }
+
+    private:
+        const char* next_;
+        const char* end_;
+    };
+
+    // Encoding of one key or mapped type in FlatMap::serialize(). Provide
+    // a specialization with
+    //     static void encode(BinaryWriter&, const T&);
+    //     static T decode(BinaryReader&);
+    // for types not covered below.
+    template <class T, class = void>
+    struct codec;
+
+    // Trivially copyable types are stored as their bytes, in host order.
+    template <class T>
+    struct codec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+        static void encode(BinaryWriter& writer, const T& value)
+        {
+            writer.write(&value, sizeof(T));
+        }
+
+        static T decode(BinaryReader& reader)
+        {
+            T value;
+            reader.read(&value, sizeof(T));
+            return value;
+        }
+    };
+
+    // Strings are a varint length followed by the characters.
+    template <class Char, class Traits, class Alloc>
+    struct codec<std::basic_string<Char, Traits, Alloc>> {
+        using string_type = std::basic_string<Char, Traits, Alloc>;
+
+        static void encode(BinaryWriter& writer, const string_type& value)
+        {
+            writer.write_varint(value.size());
+            writer.write(value.data(), value.size() * sizeof(Char));
+        }
+
+        static string_type decode(BinaryReader& reader)
+        {
+            const uint64_t length = reader.read_varint();
+            if (length > reader.remaining() / sizeof(Char)) {
+                throw std::runtime_error("FlatMap: truncated block");
+            }
+            string_type value(static_cast<size_t>(length), Char());
+            reader.read(value.data(), value.size() * sizeof(Char));
+            return value;
+        }
+    };
+
+    // Vectors are a varint element count followed by the elements.
+    template <class T, class Alloc>
+    struct codec<std::vector<T, Alloc>> {
+        static void
+        encode(BinaryWriter& writer, const std::vector<T, Alloc>& value)
+        {
+            writer.write_varint(value.size());
+            for (const auto& element : value) {
+                codec<T>::encode(writer, element);
+            }
+        }
+
+        static std::vector<T, Alloc> decode(BinaryReader& reader)
+        {
+            const uint64_t count = reader.read_varint();
+            std::vector<T, Alloc> value;
+            for (uint64_t i = 0; i < count; ++i) {
+                value.push_back(codec<T>::decode(reader));
+            }
+            return value;
+        }
+    };
+
+}; // namespace fox
+
+namespace fox::detail {
+
+    // Stream layout: a header, then blocks of whole elements, then an
+    // empty block. Integers in the framing are little-endian.
+    //   header: "FOXFSER" '\0', u32 version, u32 flags, u64 count
+    //   block:  u32 elements, u32 payload bytes, payload[, u32 crc32c]
+    inline constexpr char stream_magic[8] = {
+            'F', 'O', 'X', 'F', 'S', 'E', 'R', '\0'};
+    inline constexpr uint32_t stream_version = 1;
+    inline constexpr uint32_t stream_checksum_flag = 1;
+
+    // CRC-32C (Castagnoli), the polynomial with a dedicated instruction
+    // on x86 (SSE4.2) and ARMv8. Portable builds use slicing-by-8: eight
+    // tables that together fold eight input bytes per step.
+    inline constexpr uint32_t crc32c_polynomial = 0x82F63B78U;
+
+    constexpr std::array<std::array<uint32_t, 256>, 8> make_crc32c_tables()
+    {
+        std::array<std::array<uint32_t, 256>, 8> tables{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1U) != 0 ? (crc >> 1U) ^ crc32c_polynomial
+                                      : crc >> 1U;
+            }
+            tables[0][i] = crc;
+        }
+        for (size_t t = 1; t < 8; ++t) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                const uint32_t previous = tables[t - 1][i];
+                tables[t][i] = (previous >> 8U) ^ tables[0][previous & 0xFFU];
+            }
+        }
+        return tables;
+    }
+
+    inline constexpr std::array<std::array<uint32_t, 256>, 8> crc32c_tables
+            = make_crc32c_tables();
+
+    inline uint32_t crc32c(const char* data, size_t size)
+    {
+        uint32_t crc = 0xFFFFFFFFU;
+        size_t i = 0;
+#if defined(__SSE4_2__) && defined(__x86_64__)
+        uint64_t wide = crc;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, data + i, 8);
+            wide = _mm_crc32_u64(wide, word);
+        }
+        crc = static_cast<uint32_t>(wide);
+#else
+        const auto& t = crc32c_tables;
+        for (; i + 8 <= size; i += 8) {
+            unsigned char b[8];
+            std::memcpy(b, data + i, 8);
+            const uint32_t low = crc
+                    ^ (uint32_t{b[0]} | uint32_t{b[1]} << 8U
+                       | uint32_t{b[2]} << 16U | uint32_t{b[3]} << 24U);
+            crc = t[7][low & 0xFFU] ^ t[6][(low >> 8U) & 0xFFU]
+                    ^ t[5][(low >> 16U) & 0xFFU] ^ t[4][low >> 24U]
+                    ^ t[3][b[4]] ^ t[2][b[5]] ^ t[1][b[6]] ^ t[0][b[7]];
+        }
+#endif
+        for (; i < size; ++i) {
+            const auto byte = static_cast<unsigned char>(data[i]);
+            crc = crc32c_tables[0][(crc ^ byte) & 0xFFU] ^ (crc >> 8U);
+        }
+        return ~crc;
+    }
+
+    struct OstreamSink {
+        std::ostream& out;
+
+        void write(const char* data, size_t size)
+        {
+            out.write(data, static_cast<std::streamsize>(size));
+            if (!out) {
+                throw std::system_error(
+                        EIO, std::generic_category(), "FlatMap: write failed");
+            }
+        }
+    };
+
+    struct IstreamSource {
+        std::istream& in;
+
+        void read(char* data, size_t size)
+        {
+            in.read(data, static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(in.gcount()) != size) {
+                throw std::runtime_error("FlatMap: truncated stream");
+            }
+        }
+    };
+
+
+    template <class Sink>
+    void put_le(Sink& sink, uint64_t value, size_t bytes)
+    {
+        char buffer[8];
+        for (size_t i = 0; i < bytes; ++i) {
+            buffer[i] = static_cast<char>(value >> (8 * i));
+        }
+        sink.write(buffer, bytes);
+    }
+
+    template <class Source>
+    uint64_t get_le(Source& source, size_t bytes)
+    {
+        unsigned char buffer[8];
+        source.read(reinterpret_cast<char*>(buffer), bytes);
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    // Frames elements encoded into payload() as blocks on `sink`.
+    template <class Sink>
+    class BlockWriter {
+    public:
+        BlockWriter(Sink& sink, const SerializeOptions& options, uint64_t count)
+            : sink_(sink), options_(options)
+        {
+            sink_.write(stream_magic, sizeof(stream_magic));
+            put_le(sink_, stream_version, 4);
+            put_le(sink_, options_.checksum ? stream_checksum_flag : 0, 4);
+            put_le(sink_, count, 8);
+        }
+
+        BinaryWriter& payload()
+        {
+            return payload_;
+        }
+
+        void end_element()
+        {
+            ++elements_;
+            if (payload_.size() >= options_.blockSize) {
+                flush();
+            }
+        }
+
+        void finish()
+        {
+            flush();
+            put_le(sink_, 0, 4);
+            put_le(sink_, 0, 4);
+        }
+
+    private:
+        void flush()
+        {
+            if (elements_ == 0) {
+                return;
+            }
+            if (payload_.size() > UINT32_MAX) {
+                throw std::length_error("FlatMap: element too large");
+            }
+            put_le(sink_, elements_, 4);
+            put_le(sink_, payload_.size(), 4);
+            sink_.write(payload_.data(), payload_.size());
+            if (options_.checksum) {
+                put_le(sink_, crc32c(payload_.data(), payload_.size()), 4);
+            }
+            payload_.clear();
+            elements_ = 0;
+        }
+
+        Sink& sink_;
+        SerializeOptions options_;
+        BinaryWriter payload_;
+        uint32_t elements_ = 0;
+    };
+
+    // Reads the header, then one block at a time.
+    template <class Source>
+    class BlockReader {
+    public:
+        explicit BlockReader(Source& source) : source_(source)
+        {
+            char magic[sizeof(stream_magic)];
+            source_.read(magic, sizeof(magic));
+            if (std::memcmp(magic, stream_magic, sizeof(magic)) != 0
+                || get_le(source_, 4) != stream_version) {
+                throw std::runtime_error("FlatMap: not a serialized FlatMap");
+            }
+            checksum_ = (get_le(source_, 4) & stream_checksum_flag) != 0;
+            count_ = get_le(source_, 8);
+        }
+
+        uint64_t count() const
+        {
+            return count_;
+        }
+
+        // Loads the next block and returns its element count, or 0 after
+        // the last block.
+        size_t next_block()
+        {
+            const auto elements = static_cast<size_t>(get_le(source_, 4));
+            const auto size = static_cast<size_t>(get_le(source_, 4));
+            // Grow with the bytes actually read, so that a corrupt size
+            // fails as a truncated stream rather than a huge allocation.
+            buffer_.clear();
+            while (buffer_.size() < size) {
+                const size_t done = buffer_.size();
+                const size_t chunk = std::min(
+                        size - done, std::max(done, size_t{64} << 10U));
+                buffer_.resize(done + chunk);
+                source_.read(buffer_.data() + done, chunk);
+            }
+            if (checksum_
+                && elements > 0
+                && get_le(source_, 4) != crc32c(buffer_.data(), size)) {
+                throw std::runtime_error("FlatMap: block checksum mismatch");
+            }
+            return elements;
+        }
+
+        BinaryReader payload() const
+        {
+            const char* data = buffer_.data();
+            return BinaryReader(data, data + buffer_.size());
+        }
+
+    private:
+        Source& source_;
+        std::vector<char> buffer_;
+        uint64_t count_ = 0;
+        bool checksum_ = false;
+    };
+}; // namespace fox::detail
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <flatmap_image.hpp>
+#include <flatmap_search.hpp>
+#include <flatmap_soa.hpp>
+
+#include <algorithm>
+
+#include <cerrno>
+
+#include <cstring>
+
+#include <stdexcept>
+
+#include <string>
+
+#include <system_error>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fox {
+
+    // A read-only map served straight from a file written by
+    // FlatMap::save(). open() maps the file and validates its header;
+    // lookups and iteration then read keys and values from the page
+    // cache, so startup does no parsing and processes opening the same
+    // file share its physical pages. POSIX only.
+    template <class Key, class T, class Compare = std::less<Key>>
+    class FlatMapView {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using key_compare = Compare;
+        using size_type = size_t;
+        // The file stores keys and values in separate arrays, like
+        // FlatMapSoA, so its iterators fit the view as well.
+        using iterator =
+                typename FlatMapSoA<Key, T, Compare>::const_iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+
+    private:
+        static_assert(
+                std::is_trivially_copyable_v<Key>
+                        && std::is_trivially_copyable_v<T>,
+                "FlatMapView needs trivially copyable keys and values");
+
+        void* mapping_ = nullptr;
+        size_t length_ = 0;
+        const Key* keys_ = nullptr;
+        const T* values_ = nullptr;
+        size_t size_ = 0;
+        // First key of every indexStride_ keys; empty without an index.
+        const Key* index_ = nullptr;
+        size_t indexSize_ = 0;
+        size_t indexStride_ = 0;
+        Compare compare_;
+
+    public:
+        FlatMapView() = default;
+
+        // Throws std::system_error if the file cannot be mapped and
+        // std::runtime_error if it is not an image of this key and value
+        // type.
+        static FlatMapView open(const std::string& path)
+        {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                throw std::system_error(
+                        errno, std::generic_category(), "cannot open " + path);
+            }
+
+            struct stat info {};
+            if (::fstat(fd, &info) != 0) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(
+                        error, std::generic_category(), "cannot stat " + path);
+            }
+
+            FlatMapView view;
+            view.length_ = static_cast<size_t>(info.st_size);
+            if (view.length_ < sizeof(detail::ImageHeader)) {
+                ::close(fd);
+                throw std::runtime_error(
+                        "FlatMapView: " + path + " is not a FlatMap image");
+            }
+
+            void* mapping = ::mmap(
+                    nullptr, view.length_, PROT_READ, MAP_SHARED, fd, 0);
+            const int error = errno;
+            ::close(fd);
+            if (mapping == MAP_FAILED) {
+                throw std::system_error(
+                        error, std::generic_category(), "cannot map " + path);
+            }
+            view.mapping_ = mapping;
+            view.attach(path);
+            return view;
+        }
+
+        FlatMapView(FlatMapView&& other) noexcept
+        {
+            swap(other);
+        }
+
+        FlatMapView& operator=(FlatMapView&& other) noexcept
+        {
+            FlatMapView(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        FlatMapView(const FlatMapView&) = delete;
+        FlatMapView& operator=(const FlatMapView&) = delete;
+
+        ~FlatMapView()
+        {
+            if (mapping_ != nullptr) {
+                ::munmap(mapping_, length_);
+            }
+        }
+
+        void swap(FlatMapView& other) noexcept
+        {
+            std::swap(mapping_, other.mapping_);
+            std::swap(length_, other.length_);
+            std::swap(keys_, other.keys_);
+            std::swap(values_, other.values_);
+            std::swap(size_, other.size_);
+            std::swap(index_, other.index_);
+            std::swap(indexSize_, other.indexSize_);
+            std::swap(indexStride_, other.indexStride_);
+            std::swap(compare_, other.compare_);
+        }
+
+        iterator begin() const
+        {
+            return iterator(keys_, values_);
+        }
+
+        iterator end() const
+        {
+            return iterator(keys_ + size_, values_ + size_);
+        }
+
+        reverse_iterator rbegin() const
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const
+        {
+            return reverse_iterator(begin());
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        bool has_index() const
+        {
+            return indexSize_ > 0;
+        }
+
+        iterator lower_bound(const Key& key) const
+        {
+            const size_t index = lower_bound_index(key);
+            return begin() + static_cast<std::ptrdiff_t>(index);
+        }
+
+        iterator find(const Key& key) const
+        {
+            const size_t index = lower_bound_index(key);
+            if (index < size_ && !compare_(key, keys_[index])) {
+                return begin() + static_cast<std::ptrdiff_t>(index);
+            }
+            return end();
+        }
+
+        bool contains(const Key& key) const
+        {
+            return find(key) != end();
+        }
+
+        const T& at(const Key& key) const
+        {
+            const size_t index = lower_bound_index(key);
+            if (index < size_ && !compare_(key, keys_[index])) {
+                return values_[index];
+            }
+            throw std::out_of_range("Key not found in flatmap");
+        }
+
+    private:
+        // Points the arrays into the mapping after checking that the
+        // header describes this key and value type and fits the file.
+        void attach(const std::string& path)
+        {
+            detail::ImageHeader header;
+            std::memcpy(&header, mapping_, sizeof(header));
+
+            const auto expected = detail::make_image_header<Key, T>(
+                    header.count, header.indexCount > 0);
+            // Also compares magic, version and byte order; the count check
+            // keeps the expected offsets from overflowing.
+            const bool valid = header.count <= length_ / sizeof(Key)
+                    && std::memcmp(&header, &expected, sizeof(header)) == 0
+                    && header.fileSize <= length_;
+            if (!valid) {
+                throw std::runtime_error(
+                        "FlatMapView: " + path
+                        + " is not an image of this map type");
+            }
+
+            const auto* bytes = static_cast<const char*>(mapping_);
+            keys_ = reinterpret_cast<const Key*>(bytes + header.keysOffset);
+            values_ = reinterpret_cast<const T*>(bytes + header.valuesOffset);
+            size_ = header.count;
+            index_ = reinterpret_cast<const Key*>(bytes + header.indexOffset);
+            indexSize_ = header.indexCount;
+            indexStride_ = header.indexStride;
+        }
+
+        size_t lower_bound_index(const Key& key) const
+        {
+            size_t first = 0;
+            size_t last = size_;
+            if (indexSize_ > 0) {
+                // Index entry i is keys_[i * indexStride_], so the answer
+                // lies in the block of the last entry not above `key`.
+                const size_t block = count_not_greater(key);
+                if (block == 0) {
+                    return 0;
+                }
+                first = (block - 1) * indexStride_;
+                last = std::min(first + indexStride_, size_);
+            }
+            return first + search(keys_ + first, last - first, key);
+        }
+
+        // Number of index entries not greater than `key`, found with the
+        // same conditional-move halving as the key search.
+        size_t count_not_greater(const Key& key) const
+        {
+            const Key* base = index_;
+            size_t len = indexSize_;
+            while (len > 1) {
+                const size_t half = len / 2;
+                base = compare_(key, base[half]) ? base : base + half;
+                len -= half;
+            }
+            return static_cast<size_t>(base - index_)
+                    + static_cast<size_t>(!compare_(key, *base));
+        }
+
+        size_t search(const Key* keys, size_t count, const Key& key) const
+        {
+            if constexpr (detail::use_branchless_search<Key, Compare>) {
+                return detail::lower_bound_index(keys, count, key);
+            }
+            return static_cast<size_t>(
+                    std::lower_bound(keys, keys + count, key, compare_)
+                    - keys);
+        }
+    };
+}; // namespace fox
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <algorithm>
+
+#include <cstddef>
+
+#include <initializer_list>
+
+#include <iterator>
+
+#include <stdexcept>
+
+#include <string>
+
+#include <string_view>
+
+#include <type_traits>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A read-mostly map from strings to T for large key sets with long
+    // shared prefixes, such as URLs or paths. The keys are sorted by
+    // bytes and front coded into one byte arena: every block of
+    // BlockSize keys starts with its first key written out in full,
+    // and each following key stores only the length of the prefix it
+    // shares with the one before and the bytes after it. A lookup binary
+    // searches the block heads and then decodes forward through one
+    // block. Compared to FlatMap<std::string, T>, this drops the
+    // std::string header and the heap allocation of every long key.
+    //
+    // The key set is fixed once the map is built; mapped values stay
+    // writable through find(), at() and iterators of a non-const map.
+    // Iterators decode keys as they go, so they are forward only, and
+    // the std::string_view a dereferenced iterator holds is valid until
+    // that iterator moves.
+    template <class T, size_t BlockSize = 16>
+    class FrontCodedFlatMap {
+    public:
+        using key_type = const std::string;
+        using mapped_type = T;
+        // Keys are decoded on the fly, so elements are handed out as a
+        // pair of a view of the key and a reference to the value.
+        using value_type = std::pair<std::string_view, T&>;
+        using size_type = size_t;
+
+        static constexpr size_t block_size = BlockSize;
+
+    private:
+        static_assert(BlockSize > 0, "BlockSize must be positive");
+
+        std::vector<char> arena_;
+        // Offset in arena_ of the head key of each block.
+        std::vector<size_t> blocks_;
+        std::vector<T> values_;
+
+    public:
+        // V is T for iterator and const T for const_iterator.
+        template <class V>
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<std::string_view, V&>;
+            using difference_type = std::ptrdiff_t;
+            using reference = value_type;
+
+            struct pointer {
+                value_type pair;
+
+                const value_type* operator->() const
+                {
+                    return &pair;
+                }
+            };
+
+            Iterator() = default;
+
+            // An iterator converts to a const_iterator.
+            template <
+                    class U,
+                    class = std::enable_if_t<std::is_same_v<V, const U>>>
+            Iterator(const Iterator<U>& other)
+                : cursor_(other.cursor_),
+                  values_(other.values_),
+                  index_(other.index_),
+                  size_(other.size_),
+                  key_(other.key_)
+            {
+            }
+
+            reference operator*() const
+            {
+                return {key_, values_[index_]};
+            }
+
+            pointer operator->() const
+            {
+                return {**this};
+            }
+
+            Iterator& operator++()
+            {
+                if (++index_ < size_) {
+                    decode(cursor_, index_, key_);
+                }
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator oldValue = *this;
+                ++(*this);
+                return oldValue;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return index_ == other.index_;
+            }
+
+            bool operator!=(const Iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            template <class>
+            friend class Iterator;
+            friend class FrontCodedFlatMap;
+
+            Iterator(
+                    const char* cursor,
+                    V* values,
+                    size_t index,
+                    size_t size,
+                    std::string key)
+                : cursor_(cursor),
+                  values_(values),
+                  index_(index),
+                  size_(size),
+                  key_(std::move(key))
+            {
+            }
+
+            // Start of the encoding of the key after key_.
+            const char* cursor_ = nullptr;
+            V* values_ = nullptr;
+            size_t index_ = 0;
+            size_t size_ = 0;
+            std::string key_;
+        };
+
+        using iterator = Iterator<T>;
+        using const_iterator = Iterator<const T>;
+
+        FrontCodedFlatMap() = default;
+
+        template <typename InputIt>
+        FrontCodedFlatMap(InputIt begin, InputIt end)
+        {
+            std::vector<std::pair<std::string, T>> staging;
+            for (; begin != end; ++begin) {
+                staging.emplace_back(
+                        std::string(std::string_view(begin->first)),
+                        begin->second);
+            }
+
+            std::stable_sort(
+                    staging.begin(),
+                    staging.end(),
+                    [](const auto& lhs, const auto& rhs) {
+                        return lhs.first < rhs.first;
+                    });
+
+            // As in FlatMap, the first occurrence of each key is kept.
+            auto last = std::unique(
+                    staging.begin(),
+                    staging.end(),
+                    [](const auto& lhs, const auto& rhs) {
+                        return lhs.first == rhs.first;
+                    });
+
+            build(std::make_move_iterator(staging.begin()),
+                  std::make_move_iterator(last));
+        }
+
+        FrontCodedFlatMap(
+                std::initializer_list<std::pair<std::string_view, T>> list)
+            : FrontCodedFlatMap(list.begin(), list.end())
+        {
+        }
+
+        // Builds the map in one pass from a range sorted by key bytes
+        // without duplicates, e.g. a FlatMap<std::string, T>, so no copy
+        // of the keys is staged.
+        template <typename InputIt>
+        FrontCodedFlatMap(
+                sorted_unique_t /*unused*/, InputIt begin, InputIt end)
+        {
+            build(begin, end);
+        }
+
+        iterator begin()
+        {
+            return to_mutable(cbegin());
+        }
+
+        const_iterator begin() const
+        {
+            return cbegin();
+        }
+
+        const_iterator cbegin() const
+        {
+            return block_begin(0);
+        }
+
+        iterator end()
+        {
+            return iterator(nullptr, nullptr, size(), size(), {});
+        }
+
+        const_iterator end() const
+        {
+            return cend();
+        }
+
+        const_iterator cend() const
+        {
+            return const_iterator(nullptr, nullptr, size(), size(), {});
+        }
+
+        size_t size() const
+        {
+            return values_.size();
+        }
+
+        bool empty() const
+        {
+            return values_.empty();
+        }
+
+        // Bytes held by the map, its own included.
+        size_t bytes() const
+        {
+            return sizeof(*this) + arena_.capacity()
+                    + blocks_.capacity() * sizeof(size_t)
+                    + values_.capacity() * sizeof(T);
+        }
+
+        iterator lower_bound(std::string_view key)
+        {
+            return to_mutable(std::as_const(*this).lower_bound(key));
+        }
+
+        const_iterator lower_bound(std::string_view key) const
+        {
+            // The last block whose head is not above `key` holds its lower
+            // bound, or is followed by a block starting with it.
+            size_t low = 0;
+            size_t len = blocks_.size();
+            while (len > 0) {
+                const size_t half = len / 2;
+                if (!(key < head(low + half))) {
+                    low += half + 1;
+                    len -= half + 1;
+                } else {
+                    len = half;
+                }
+            }
+            if (low == 0) {
+                return begin();
+            }
+            return scan(low - 1, key);
+        }
+
+        iterator find(std::string_view key)
+        {
+            return to_mutable(std::as_const(*this).find(key));
+        }
+
+        const_iterator find(std::string_view key) const
+        {
+            auto iter = lower_bound(key);
+            if (iter != end() && iter.key_ == key) {
+                return iter;
+            }
+            return end();
+        }
+
+        T& at(std::string_view key)
+        {
+            return values_[index_of(key)];
+        }
+
+        const T& at(std::string_view key) const
+        {
+            return values_[index_of(key)];
+        }
+
+        bool contains(std::string_view key) const
+        {
+            return find(key) != end();
+        }
+
+        size_t count(std::string_view key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+    private:
+        iterator to_mutable(const_iterator iter)
+        {
+            return iterator(
+                    iter.cursor_,
+                    values_.data(),
+                    iter.index_,
+                    iter.size_,
+                    std::move(iter.key_));
+        }
+
+        size_t index_of(std::string_view key) const
+        {
+            const auto iter = find(key);
+            if (iter == end()) {
+                throw std::out_of_range("Key not found in flatmap");
+            }
+            return iter.index_;
+        }
+
+        template <typename InputIt>
+        void build(InputIt begin, InputIt end)
+        {
+            std::string previous;
+            for (; begin != end; ++begin) {
+                const std::string_view key(begin->first);
+                size_t shared = 0;
+                if (values_.size() % BlockSize == 0) {
+                    blocks_.push_back(arena_.size());
+                } else {
+                    shared = common_prefix(previous, key);
+                    put_varint(shared);
+                }
+                put_varint(key.size() - shared);
+                arena_.insert(arena_.end(), key.begin() + shared, key.end());
+                previous.assign(key);
+                values_.push_back(begin->second);
+            }
+            arena_.shrink_to_fit();
+            blocks_.shrink_to_fit();
+            values_.shrink_to_fit();
+        }
+
+        std::string_view head(size_t block) const
+        {
+            const char* cursor = arena_.data() + blocks_[block];
+            const size_t length = get_varint(cursor);
+            return {cursor, length};
+        }
+
+        const_iterator block_begin(size_t block) const
+        {
+            const size_t index = block * BlockSize;
+            if (index >= size()) {
+                return end();
+            }
+            const char* cursor = arena_.data() + blocks_[block];
+            std::string key;
+            decode(cursor, index, key);
+            return const_iterator(
+                    cursor, values_.data(), index, size(), std::move(key));
+        }
+
+        // Finds the lower bound of `key` from the start of `block`, whose
+        // head is not above `key`. Tracks how many leading bytes the current
+        // key shares with `key`; a following key sharing more with the
+        // current one is below `key` too, and one sharing less is above
+        // it, so only the bytes of a key sharing exactly as many are ever
+        // compared.
+        const_iterator scan(size_t block, std::string_view key) const
+        {
+            const char* cursor = arena_.data() + blocks_[block];
+            size_t index = block * BlockSize;
+            std::string current;
+            decode(cursor, index, current);
+
+            size_t matched = common_prefix(current, key);
+            if (matched == key.size()) {
+                return const_iterator(
+                        cursor,
+                        values_.data(),
+                        index,
+                        size(),
+                        std::move(current));
+            }
+
+            const size_t last = std::min(index + BlockSize, size());
+            while (++index < last) {
+                const size_t shared = get_varint(cursor);
+                const size_t length = get_varint(cursor);
+                const std::string_view suffix(cursor, length);
+                cursor += length;
+                current.resize(shared);
+                current.append(suffix);
+
+                if (shared > matched) {
+                    continue;
+                }
+                if (shared == matched) {
+                    const size_t extra
+                            = common_prefix(suffix, key.substr(matched));
+                    matched += extra;
+                    if (matched < key.size()
+                        && (extra == length
+                            || static_cast<unsigned char>(suffix[extra])
+                                    < static_cast<unsigned char>(
+                                            key[matched]))) {
+                        continue;
+                    }
+                }
+                return const_iterator(
+                        cursor,
+                        values_.data(),
+                        index,
+                        size(),
+                        std::move(current));
+            }
+            return block_begin(block + 1);
+        }
+
+        // Reads the key at `index` from `cursor` into `key`, which holds
+        // the key before it unless `index` starts a block.
+        static void decode(
+                const char*& cursor, size_t index, std::string& key)
+        {
+            const size_t shared
+                    = index % BlockSize == 0 ? 0 : get_varint(cursor);
+            const size_t length = get_varint(cursor);
+            key.resize(shared);
+            key.append(cursor, length);
+            cursor += length;
+        }
+
+        static size_t common_prefix(
+                std::string_view lhs, std::string_view rhs)
+        {
+            const size_t length = std::min(lhs.size(), rhs.size());
+            return static_cast<size_t>(
+                    std::mismatch(
+                            lhs.begin(), lhs.begin() + length, rhs.begin())
+                            .first
+                    - lhs.begin());
+        }
+
+        // Lengths as LEB128, one byte for those under 128.
+        void put_varint(size_t value)
+        {
+            while (value >= 0x80U) {
+                arena_.push_back(static_cast<char>(value | 0x80U));
+                value >>= 7U;
+            }
+            arena_.push_back(static_cast<char>(value));
+        }
+
+        static size_t get_varint(const char*& cursor)
+        {
+            size_t value = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                const auto byte = static_cast<unsigned char>(*cursor++);
+                value |= static_cast<size_t>(byte & 0x7FU) << shift;
+                if (byte < 0x80U) {
+                    return value;
+                }
+            }
+        }
+    };
+}; // namespace fox
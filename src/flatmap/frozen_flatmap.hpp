@@ -0,0 +1,205 @@
+#pragma once
+
+#include <flatmap.hpp>
+#include <flatmap_search.hpp>
+
+#include <algorithm>
+
+#include <initializer_list>
+
+#include <stdexcept>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A read-mostly view of a FlatMap whose key set is fixed. Lookups go
+    // through a copy of the keys in Eytzinger (BFS) order, where the next
+    // few levels of the search tree share cache lines and are prefetched,
+    // while iteration still walks the sorted FlatMap. Mapped values stay
+    // writable through find() and at().
+    template <class Key, class T, class Compare = std::less<Key>>
+    class FrozenFlatMap {
+    public:
+        using map_type = FlatMap<Key, T, Compare>;
+        using key_type = typename map_type::key_type;
+        using mapped_type = typename map_type::mapped_type;
+        using value_type = typename map_type::value_type;
+        using size_type = typename map_type::size_type;
+        using iterator = typename map_type::iterator;
+        using reverse_iterator = typename map_type::reverse_iterator;
+
+    private:
+        // Each cache line holds this many keys, so prefetching child k
+        // times the stride pulls in its descendants that many levels down.
+        static constexpr size_t prefetch_stride = std::max<size_t>(
+                1, size_t{64} / std::max<size_t>(1, sizeof(Key)));
+
+        map_type map_;
+        // Slot 0 is unused; the children of slot k are 2k and 2k + 1.
+        std::vector<Key> index_;
+        // Depth of the deepest tree level and the number of nodes on it.
+        size_t height_ = 0;
+        size_t lastLevel_ = 0;
+        Compare compare_;
+
+    public:
+        FrozenFlatMap() = default;
+
+        FrozenFlatMap(map_type&& map) : map_(std::move(map))
+        {
+            build_index();
+        }
+
+        FrozenFlatMap(const map_type& map) : map_(map)
+        {
+            build_index();
+        }
+
+        template <typename InputIt>
+        FrozenFlatMap(InputIt begin, InputIt end) : map_(begin, end)
+        {
+            build_index();
+        }
+
+        FrozenFlatMap(std::initializer_list<value_type> list) : map_(list)
+        {
+            build_index();
+        }
+
+        // Hands the underlying map back for modification.
+        map_type thaw() &&
+        {
+            index_.clear();
+            height_ = 0;
+            lastLevel_ = 0;
+            return std::move(map_);
+        }
+
+        iterator begin() const
+        {
+            return map_.begin();
+        }
+        iterator end() const
+        {
+            return map_.end();
+        }
+
+        reverse_iterator rbegin() const
+        {
+            return map_.rbegin();
+        }
+        reverse_iterator rend() const
+        {
+            return map_.rend();
+        }
+
+        iterator lower_bound(const Key& key) const
+        {
+            return map_.begin()
+                    + static_cast<std::ptrdiff_t>(lower_bound_index(key));
+        }
+
+        iterator find(const Key& key) const
+        {
+            auto iter = lower_bound(key);
+
+            if (iter != end() && !(compare_(key, iter->first))) {
+                return iter;
+            }
+
+            return end();
+        }
+
+        mapped_type& at(const Key& key) const
+        {
+            auto iter = find(key);
+
+            if (iter != end()) {
+                return iter->second;
+            }
+
+            throw std::out_of_range("Key not found in flatmap");
+        }
+
+        bool contains(const Key& key) const
+        {
+            return find(key) != end();
+        }
+
+        bool empty() const
+        {
+            return map_.empty();
+        }
+
+        size_t size() const
+        {
+            return map_.size();
+        }
+
+    private:
+        void build_index()
+        {
+            index_.resize(map_.size() + 1);
+            if (!map_.empty()) {
+                height_ = detail::log2_floor(map_.size());
+                lastLevel_ = map_.size() - ((size_t{1} << height_) - 1);
+            }
+
+            // An in-order walk of the implicit tree visits slots in key
+            // order, so it assigns the sorted elements one by one.
+            size_t next = 0;
+            std::vector<size_t> stack;
+            size_t slot = 1;
+            while (slot <= map_.size() || !stack.empty()) {
+                if (slot <= map_.size()) {
+                    stack.push_back(slot);
+                    slot *= 2;
+                    continue;
+                }
+
+                slot = stack.back();
+                stack.pop_back();
+                index_[slot] = map_.begin()[next].first;
+                ++next;
+                slot = slot * 2 + 1;
+            }
+        }
+
+        size_t lower_bound_index(const Key& key) const
+        {
+            const size_t size = map_.size();
+            const Key* index = index_.data();
+
+            size_t slot = 1;
+            while (slot <= size) {
+                if (slot * prefetch_stride <= size) {
+                    detail::prefetch(index + slot * prefetch_stride);
+                }
+                slot = slot * 2
+                        + static_cast<size_t>(compare_(index[slot], key));
+            }
+
+            // Undo the trailing right turns (and the last left turn) to
+            // reach the last node whose key was not less than `key`.
+            slot >>= detail::trailing_ones(slot) + 1;
+
+            return slot == 0 ? size : rank(slot);
+        }
+
+        // In-order position of `slot`: its position in a perfect tree of
+        // the same height, minus the absent leaves that would precede it.
+        size_t rank(size_t slot) const
+        {
+            const size_t depth = detail::log2_floor(slot);
+            const size_t offset = slot - (size_t{1} << depth);
+            const size_t perfect = ((2 * offset + 1) << (height_ - depth)) - 1;
+            const size_t leaves = (perfect + 1) / 2;
+
+            return leaves > lastLevel_ ? perfect - (leaves - lastLevel_)
+                                       : perfect;
+        }
+    };
+}; // namespace fox
@@ -0,0 +1,897 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <algorithm>
+
+#include <cstdint>
+
+#include <iterator>
+
+#include <memory>
+
+#include <new>
+
+#include <stdexcept>
+
+#include <tuple>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A sorted map stored as a packed memory array: the slots are split
+    // into segments of segment_size, each holding its elements packed at
+    // its start and leaving the rest as a gap. An insert or erase shifts
+    // elements within one segment; only when a segment overflows, or
+    // falls below an eighth full, is the smallest enclosing window of
+    // segments that is within its density bounds spread out evenly again.
+    // The bounds tighten from the segments towards the whole array, which
+    // keeps the amortized cost of a random insert at O(log² N) moves
+    // instead of FlatMap's O(N).
+    //
+    // Iteration walks the packed runs and jumps from the end of one run
+    // to the start of the next, so it never reads a gap slot. Any insert
+    // or erase invalidates iterators.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class Allocator = std::allocator<std::pair<const Key, T>>>
+    class PackedFlatMap {
+    public:
+        using key_type = const Key;
+        using mapped_type = T;
+        using value_type = std::pair<key_type, mapped_type>;
+        using allocator_type = Allocator;
+        using size_type = size_t;
+
+        static constexpr size_t segment_size = 64;
+
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+        using count_type = uint32_t;
+
+        static_assert(
+                std::is_same_v<typename alloc_traits::value_type, value_type>,
+                "Allocator must allocate PackedFlatMap::value_type");
+
+        // As in FlatMap, elements are built with a mutable key so that
+        // shifting can move-assign them.
+        using storage_type = std::pair<Key, T>;
+
+        // Whether elements can be moved between slots without throwing.
+        // Windows are only rebalanced in place when they can; otherwise
+        // the whole array is rebuilt from copies, which leaves the map
+        // unchanged if one throws.
+        static constexpr bool nothrow_relocate =
+                std::is_nothrow_move_constructible_v<storage_type>;
+
+        value_type* slots_ = nullptr;
+        // Number of elements at the start of each segment.
+        std::vector<count_type> counts_;
+        size_t size_ = 0;
+        Allocator alloc_;
+        Compare compare_;
+
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = PackedFlatMap::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type*;
+            using reference = value_type&;
+
+            Iterator() = default;
+
+            reference operator*() const
+            {
+                return *data_;
+            }
+
+            pointer operator->() const
+            {
+                return data_;
+            }
+
+            Iterator& operator++()
+            {
+                if (++data_ == runEnd_) {
+                    // Jump over the gap to the start of the next run.
+                    data_ = runEnd_ - *count_ + segment_size;
+                    ++count_;
+                    runEnd_ = data_ + (count_ != countEnd_ ? *count_ : 0);
+                }
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator oldValue = *this;
+                ++(*this);
+                return oldValue;
+            }
+
+            Iterator& operator--()
+            {
+                const size_t count = count_ != countEnd_ ? *count_ : 0;
+                if (data_ == runEnd_ - count) {
+                    --count_;
+                    runEnd_ = data_ - segment_size + *count_;
+                    data_ = runEnd_;
+                }
+                --data_;
+                return *this;
+            }
+
+            Iterator operator--(int)
+            {
+                Iterator oldValue = *this;
+                --(*this);
+                return oldValue;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return data_ == other.data_;
+            }
+
+            bool operator!=(const Iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            friend class PackedFlatMap;
+
+            Iterator(
+                    value_type* data,
+                    value_type* runEnd,
+                    const count_type* count,
+                    const count_type* countEnd)
+                : data_(data),
+                  runEnd_(runEnd),
+                  count_(count),
+                  countEnd_(countEnd)
+            {
+            }
+
+            value_type* data_ = nullptr;
+            // End of the run holding data_, which only end() points at.
+            value_type* runEnd_ = nullptr;
+            const count_type* count_ = nullptr;
+            const count_type* countEnd_ = nullptr;
+        };
+
+        using iterator = Iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+
+        PackedFlatMap() = default;
+
+        explicit PackedFlatMap(const Allocator& alloc) : alloc_(alloc)
+        {
+        }
+
+        // Builds the map from a sorted range of unique keys in one pass.
+        template <typename InputIt>
+        PackedFlatMap(
+                sorted_unique_t /*unused*/,
+                InputIt begin,
+                InputIt end,
+                const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+        {
+            std::vector<std::pair<Key, T>> staging(begin, end);
+            allocate_segments(segments_for(staging.size()));
+            try {
+                size_t next = 0;
+                for (size_t segment = 0; segment < counts_.size();
+                     ++segment) {
+                    const size_t share = share_of(
+                            staging.size(), counts_.size(), segment);
+                    value_type* data = segment_data(segment);
+                    for (count_type& count = counts_[segment]; count < share;
+                         ++count) {
+                        construct(&data[count], std::move(staging[next++]));
+                    }
+                }
+                size_ = staging.size();
+            } catch (...) {
+                release();
+                throw;
+            }
+        }
+
+        PackedFlatMap(const PackedFlatMap& other)
+            : PackedFlatMap(
+                    other,
+                    alloc_traits::select_on_container_copy_construction(
+                            other.alloc_))
+        {
+        }
+
+        PackedFlatMap(const PackedFlatMap& other, const Allocator& alloc)
+            : alloc_(alloc), compare_(other.compare_)
+        {
+            fill_from(other);
+        }
+
+        PackedFlatMap(PackedFlatMap&& other) noexcept
+            : alloc_(std::move(other.alloc_)),
+              compare_(std::move(other.compare_))
+        {
+            swap_storage(other);
+        }
+
+        PackedFlatMap(PackedFlatMap&& other, const Allocator& alloc)
+            : alloc_(alloc), compare_(other.compare_)
+        {
+            if (alloc_ == other.alloc_) {
+                swap_storage(other);
+            } else {
+                fill_from(std::move(other));
+            }
+        }
+
+        PackedFlatMap& operator=(const PackedFlatMap& other)
+        {
+            if (this != &other) {
+                if constexpr (alloc_traits::
+                                      propagate_on_container_copy_assignment::
+                                              value) {
+                    if (alloc_ != other.alloc_) {
+                        release();
+                    }
+                    alloc_ = other.alloc_;
+                }
+
+                PackedFlatMap temp(other, alloc_);
+                swap_storage(temp);
+                compare_ = other.compare_;
+            }
+            return *this;
+        }
+
+        PackedFlatMap& operator=(PackedFlatMap&& other) noexcept(
+                alloc_traits::propagate_on_container_move_assignment::value
+                || alloc_traits::is_always_equal::value)
+        {
+            if (this != &other) {
+                constexpr bool propagate = alloc_traits::
+                        propagate_on_container_move_assignment::value;
+
+                if (propagate || alloc_ == other.alloc_) {
+                    release();
+                    if constexpr (propagate) {
+                        alloc_ = std::move(other.alloc_);
+                    }
+                    swap_storage(other);
+                } else {
+                    // Storage owned by an unequal allocator cannot be
+                    // adopted, so the elements are moved one by one.
+                    PackedFlatMap temp(std::move(other), alloc_);
+                    swap_storage(temp);
+                }
+                compare_ = std::move(other.compare_);
+            }
+            return *this;
+        }
+
+        ~PackedFlatMap()
+        {
+            release();
+        }
+
+        iterator begin() const
+        {
+            return size_ == 0 ? end() : make_iterator(0, 0);
+        }
+
+        iterator end() const
+        {
+            return make_iterator(counts_.size(), 0);
+        }
+
+        reverse_iterator rbegin() const
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const
+        {
+            return reverse_iterator(begin());
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        allocator_type get_allocator() const
+        {
+            return alloc_;
+        }
+
+        // Number of slots, including gaps.
+        size_t capacity() const
+        {
+            return counts_.size() * segment_size;
+        }
+
+        std::pair<iterator, bool> insert(const Key& key, const T& value)
+        {
+            return try_emplace(key, value);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            if (counts_.empty()) {
+                resize(1);
+            }
+
+            size_t segment = size_ == 0 ? 0 : find_segment(key);
+            size_t index = lower_bound_in(segment, key);
+            if (index < counts_[segment]
+                && !compare_(key, segment_data(segment)[index].first)) {
+                return {make_iterator(segment, index), false};
+            }
+
+            // Built before anything moves, so that a throwing constructor
+            // leaves the map as it was.
+            storage_type value(
+                    std::piecewise_construct,
+                    std::forward_as_tuple(key),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            while (true) {
+                if (counts_[segment] < segment_size) {
+                    insert_at(
+                            segment_data(segment),
+                            counts_[segment],
+                            index,
+                            std::move(value));
+                    return {make_iterator(segment, index), true};
+                }
+
+                if (rebalance_for_insert(segment, index, std::move(value))) {
+                    return {find(key), true};
+                }
+                // No window has room: double the array and retry.
+                resize(counts_.size() * 2);
+                segment = find_segment(key);
+                index = lower_bound_in(segment, key);
+            }
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value)
+        {
+            // try_emplace() leaves `value` alone when the key exists.
+            auto result = try_emplace(key, std::forward<M>(value));
+            if (!result.second) {
+                result.first->second = std::forward<M>(value);
+            }
+            return result;
+        }
+
+        T& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& at(const Key& key)
+        {
+            return at_impl(key);
+        }
+
+        const T& at(const Key& key) const
+        {
+            return at_impl(key);
+        }
+
+        iterator find(const Key& key) const
+        {
+            if (size_ == 0) {
+                return end();
+            }
+            const size_t segment = find_segment(key);
+            const size_t index = lower_bound_in(segment, key);
+            if (index < counts_[segment]
+                && !compare_(key, segment_data(segment)[index].first)) {
+                return make_iterator(segment, index);
+            }
+            return end();
+        }
+
+        iterator lower_bound(const Key& key) const
+        {
+            if (size_ == 0) {
+                return end();
+            }
+            const size_t segment = find_segment(key);
+            const size_t index = lower_bound_in(segment, key);
+            if (index < counts_[segment]) {
+                return make_iterator(segment, index);
+            }
+            // Past this run: the next run starts above `key`.
+            return make_iterator(segment + 1, 0);
+        }
+
+        bool contains(const Key& key) const
+        {
+            return find(key) != end();
+        }
+
+        size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        size_t erase(const Key& key)
+        {
+            if (size_ == 0) {
+                return 0;
+            }
+            const size_t segment = find_segment(key);
+            value_type* data = segment_data(segment);
+            const size_t index = lower_bound_in(segment, key);
+            if (index == counts_[segment]
+                || compare_(key, data[index].first)) {
+                return 0;
+            }
+
+            const bool sparse = counts_.size() > 1
+                    && (counts_[segment] - 1) * 8 < segment_size;
+            if constexpr (!nothrow_relocate) {
+                if (sparse) {
+                    // Rebuilding without the element, rather than erasing
+                    // it first, leaves the map as it was if a copy throws.
+                    rebuild(erase_window(segment, 1) != 0
+                                    ? counts_.size()
+                                    : segments_for(size_ - 1),
+                            0,
+                            nullptr,
+                            &data[index]);
+                    return 1;
+                }
+            }
+
+            erase_at(data, counts_[segment], index);
+            --counts_[segment];
+            --size_;
+            if (sparse) {
+                rebalance_for_erase(segment);
+            }
+            return 1;
+        }
+
+        void clear()
+        {
+            release();
+        }
+
+    private:
+        iterator make_iterator(size_t segment, size_t offset) const
+        {
+            value_type* data = segment_data(segment);
+            const count_type* counts = counts_.data();
+            const size_t count
+                    = segment < counts_.size() ? counts[segment] : 0;
+            return iterator(
+                    data + offset,
+                    data + count,
+                    counts + segment,
+                    counts + counts_.size());
+        }
+
+        value_type* segment_data(size_t segment) const
+        {
+            return slots_ + segment * segment_size;
+        }
+
+        // Last segment whose first key is not greater than `key`, or the
+        // first segment. Every segment holds elements while the map does.
+        size_t find_segment(const Key& key) const
+        {
+            size_t base = 0;
+            size_t len = counts_.size();
+            while (len > 1) {
+                const size_t half = len / 2;
+                base = compare_(key, segment_data(base + half)->first)
+                        ? base
+                        : base + half;
+                len -= half;
+            }
+            return base;
+        }
+
+        size_t lower_bound_in(size_t segment, const Key& key) const
+        {
+            const value_type* data = segment_data(segment);
+            return static_cast<size_t>(
+                    std::lower_bound(
+                            data,
+                            data + counts_[segment],
+                            key,
+                            [this](const value_type& element, const Key& key) {
+                                return compare_(element.first, key);
+                            })
+                    - data);
+        }
+
+        // Smallest segment count that fills the slots at most half way.
+        static size_t segments_for(size_t count)
+        {
+            size_t segments = 1;
+            while (segments * segment_size / 2 < count) {
+                segments *= 2;
+            }
+            return segments;
+        }
+
+        static size_t height_of(size_t segments)
+        {
+            size_t height = 0;
+            while ((size_t(1) << height) < segments) {
+                ++height;
+            }
+            return height;
+        }
+
+        size_t window_count(size_t first, size_t width) const
+        {
+            size_t count = 0;
+            for (size_t segment = first; segment < first + width; ++segment) {
+                count += counts_[segment];
+            }
+            return count;
+        }
+
+        // Finds the smallest window around `segment` that stays within its
+        // upper density bound with one more element, which falls from 1
+        // for a single segment to 3/4 for the whole array, and spreads the
+        // window out with the new element at `index` of `segment`. Returns
+        // false if even the whole array is too dense.
+        bool rebalance_for_insert(
+                size_t segment, size_t index, storage_type&& value)
+        {
+            const size_t height = height_of(counts_.size());
+            for (size_t level = 1; level <= height; ++level) {
+                const size_t width = size_t(1) << level;
+                const size_t first = segment & ~(width - 1);
+                const size_t count = window_count(first, width) + 1;
+                if (count * 4 * height
+                    > width * segment_size * (4 * height - level)) {
+                    continue;
+                }
+
+                if constexpr (nothrow_relocate) {
+                    const size_t position
+                            = window_count(first, segment - first) + index;
+                    value_type* base = segment_data(first);
+                    count_type packed = static_cast<count_type>(
+                            pack(first, width));
+                    insert_at(base, packed, position, std::move(value));
+                    spread(base, packed, base, &counts_[first], width);
+                } else {
+                    rebuild(counts_.size(),
+                            window_count(0, segment) + index,
+                            &value);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        // Width of the smallest window around `segment` that stays above
+        // its lower density bound, which rises from 1/8 for a single
+        // segment to 1/4 for the whole array, once `removed` more of its
+        // elements are gone; 0 if even the whole array is too sparse.
+        size_t erase_window(size_t segment, size_t removed) const
+        {
+            const size_t height = height_of(counts_.size());
+            for (size_t level = 1; level <= height; ++level) {
+                const size_t width = size_t(1) << level;
+                const size_t first = segment & ~(width - 1);
+                const size_t count = window_count(first, width) - removed;
+                if (count * 8 * height
+                    >= width * segment_size * (height + level)) {
+                    return width;
+                }
+            }
+            return 0;
+        }
+
+        // Spreads out the window erase_window() finds, or shrinks the
+        // array if there is none.
+        void rebalance_for_erase(size_t segment)
+        {
+            const size_t width = erase_window(segment, 0);
+            if (width == 0) {
+                resize(segments_for(size_));
+                return;
+            }
+            const size_t first = segment & ~(width - 1);
+            value_type* base = segment_data(first);
+            spread(base, pack(first, width), base, &counts_[first], width);
+        }
+
+        // Moves the elements of a window to its first slots, in order, and
+        // returns their number. Only used when relocating cannot throw:
+        // counts_ does not describe the window until spread() is done.
+        size_t pack(size_t first, size_t width)
+        {
+            value_type* target = segment_data(first);
+            for (size_t segment = first; segment < first + width; ++segment) {
+                value_type* source = segment_data(segment);
+                for (size_t i = 0; i < counts_[segment]; ++i) {
+                    if (target != &source[i]) {
+                        construct(target, std::move(storage(source[i])));
+                        destroy(&source[i]);
+                    }
+                    ++target;
+                }
+            }
+            return static_cast<size_t>(target - segment_data(first));
+        }
+
+        // Moves `count` packed elements from `source` into the `width`
+        // segments starting at `target`, as evenly as possible. Works in
+        // place: every element moves right, so going from the last one
+        // never overwrites an element that still has to move. Only used
+        // when relocating cannot throw, like pack().
+        void spread(
+                value_type* source,
+                size_t count,
+                value_type* target,
+                count_type* counts,
+                size_t width)
+        {
+            const size_t share = count / width;
+            const size_t extra = count % width;
+            size_t next = count;
+            for (size_t segment = width; segment-- > 0;) {
+                const size_t segmentCount = share + (segment < extra ? 1 : 0);
+                value_type* data = target + segment * segment_size;
+                for (size_t i = segmentCount; i-- > 0;) {
+                    --next;
+                    if (&data[i] != &source[next]) {
+                        construct(
+                                &data[i], std::move(storage(source[next])));
+                        destroy(&source[next]);
+                    }
+                }
+                counts[segment] = static_cast<count_type>(segmentCount);
+            }
+        }
+
+        // Number of `count` elements spread evenly over `segments`
+        // segments that go to `segment`.
+        static size_t share_of(size_t count, size_t segments, size_t segment)
+        {
+            return count / segments + (segment < count % segments ? 1 : 0);
+        }
+
+        // Moves every element into a new array of `segments` segments.
+        void resize(size_t segments)
+        {
+            rebuild(segments);
+        }
+
+        // Builds a new array of `segments` segments holding every element
+        // but `*skip`, plus `*value` at `position` if given, spread evenly
+        // and sets size_ to match. Everything
+        // is allocated before the first element moves, and elements are
+        // copied unless moving them cannot throw, so if anything throws
+        // the new array is freed and the map is left as it was.
+        void rebuild(
+                size_t segments,
+                size_t position = 0,
+                storage_type* value = nullptr,
+                const value_type* skip = nullptr)
+        {
+            const size_t total = size_ + (value != nullptr ? 1 : 0)
+                    - (skip != nullptr ? 1 : 0);
+            std::vector<count_type> counts(segments);
+            value_type* slots = allocate(segments * segment_size);
+
+            size_t sourceSegment = 0;
+            size_t sourceIndex = 0;
+            size_t next = 0;
+            try {
+                for (size_t segment = 0; segment < segments; ++segment) {
+                    const size_t share = share_of(total, segments, segment);
+                    value_type* data = slots + segment * segment_size;
+                    for (count_type& count = counts[segment]; count < share;
+                         ++count, ++next) {
+                        if (value != nullptr && next == position) {
+                            construct(
+                                    &data[count],
+                                    std::move_if_noexcept(*value));
+                            continue;
+                        }
+                        while (sourceIndex == counts_[sourceSegment]
+                               || &segment_data(sourceSegment)[sourceIndex]
+                                       == skip) {
+                            if (sourceIndex == counts_[sourceSegment]) {
+                                ++sourceSegment;
+                                sourceIndex = 0;
+                            } else {
+                                ++sourceIndex;
+                            }
+                        }
+                        construct(
+                                &data[count],
+                                std::move_if_noexcept(storage(segment_data(
+                                        sourceSegment)[sourceIndex])));
+                        ++sourceIndex;
+                    }
+                }
+            } catch (...) {
+                for (size_t segment = 0; segment < segments; ++segment) {
+                    value_type* data = slots + segment * segment_size;
+                    for (size_t i = 0; i < counts[segment]; ++i) {
+                        destroy(&data[i]);
+                    }
+                }
+                deallocate(slots, segments * segment_size);
+                throw;
+            }
+
+            release();
+            slots_ = slots;
+            counts_ = std::move(counts);
+            size_ = total;
+        }
+
+        void allocate_segments(size_t segments)
+        {
+            slots_ = allocate(segments * segment_size);
+            counts_.assign(segments, 0);
+        }
+
+        // Lays the elements of `other` out in the same segments, copying
+        // them, or moving them if `other` is an rvalue.
+        template <class Other>
+        void fill_from(Other&& other)
+        {
+            constexpr bool move = !std::is_const_v<
+                    std::remove_reference_t<Other>>;
+
+            allocate_segments(other.counts_.size());
+            try {
+                for (size_t segment = 0; segment < counts_.size();
+                     ++segment) {
+                    value_type* source = other.segment_data(segment);
+                    value_type* target = segment_data(segment);
+                    for (count_type& count = counts_[segment];
+                         count < other.counts_[segment];
+                         ++count) {
+                        if constexpr (move) {
+                            construct(
+                                    &target[count],
+                                    std::move(storage(source[count])));
+                        } else {
+                            construct(&target[count], source[count]);
+                        }
+                    }
+                    size_ += counts_[segment];
+                }
+            } catch (...) {
+                release();
+                throw;
+            }
+        }
+
+        // Shifts the run up by move-assignment; only the slot past its
+        // end is constructed, and `count` and size_ cover it from then on.
+        void insert_at(
+                value_type* data,
+                count_type& count,
+                size_t index,
+                storage_type&& value)
+        {
+            const size_t last = count;
+            if (index == last) {
+                construct(&data[index], std::move(value));
+                ++count;
+                ++size_;
+                return;
+            }
+            construct(&data[last], std::move(storage(data[last - 1])));
+            ++count;
+            ++size_;
+            for (size_t i = last - 1; i > index; --i) {
+                storage(data[i]) = std::move(storage(data[i - 1]));
+            }
+            storage(data[index]) = std::move(value);
+        }
+
+        void erase_at(value_type* data, size_t count, size_t index)
+        {
+            for (size_t i = index + 1; i < count; ++i) {
+                storage(data[i - 1]) = std::move(storage(data[i]));
+            }
+            destroy(&data[count - 1]);
+        }
+
+        value_type* allocate(size_t count)
+        {
+            return alloc_traits::allocate(alloc_, count);
+        }
+
+        void deallocate(value_type* data, size_t count)
+        {
+            if (data != nullptr) {
+                alloc_traits::deallocate(alloc_, data, count);
+            }
+        }
+
+        template <class... Args>
+        void construct(value_type* slot, Args&&... args)
+        {
+            alloc_traits::construct(
+                    alloc_,
+                    reinterpret_cast<storage_type*>(slot),
+                    std::forward<Args>(args)...);
+        }
+
+        void destroy(value_type* slot)
+        {
+            alloc_traits::destroy(alloc_, &storage(*slot));
+        }
+
+        static storage_type& storage(value_type& element)
+        {
+            return *std::launder(reinterpret_cast<storage_type*>(&element));
+        }
+
+        void release()
+        {
+            for (size_t segment = 0; segment < counts_.size(); ++segment) {
+                value_type* data = segment_data(segment);
+                for (size_t i = 0; i < counts_[segment]; ++i) {
+                    destroy(&data[i]);
+                }
+            }
+            deallocate(slots_, capacity());
+            slots_ = nullptr;
+            counts_.clear();
+            size_ = 0;
+        }
+
+        void swap_storage(PackedFlatMap& other) noexcept
+        {
+            std::swap(slots_, other.slots_);
+            std::swap(counts_, other.counts_);
+            std::swap(size_, other.size_);
+        }
+
+        T& at_impl(const Key& key) const
+        {
+            auto iter = find(key);
+            if (iter == end()) {
+                throw std::out_of_range("Key not found in flatmap");
+            }
+            return iter->second;
+        }
+    };
+}; // namespace fox
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <algorithm>
+
+#include <iterator>
+
+#include <memory>
+
+#include <mutex>
+
+#include <optional>
+
+#include <utility>
+
+#include <vector>
+
+namespace fox {
+
+    // A FlatMap split by key range into independently locked shards, so
+    // writers touching different ranges proceed in parallel and each
+    // insert only shifts the elements of one shard. Shard boundaries are
+    // quantiles of a key sample given at construction; rebalance()
+    // recomputes them from the stored keys once the distribution is known.
+    //
+    // Point operations, for_each() and for_each_range() are safe to call
+    // concurrently. Iterators and rebalance() require that no other
+    // thread uses the map at the same time.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class Allocator = std::allocator<std::pair<const Key, T>>>
+    class ShardedFlatMap {
+    public:
+        using map_type = FlatMap<Key, T, Compare, Allocator>;
+        using key_type = typename map_type::key_type;
+        using mapped_type = typename map_type::mapped_type;
+        using value_type = typename map_type::value_type;
+        using size_type = typename map_type::size_type;
+
+    private:
+        struct alignas(64) Shard {
+            mutable std::mutex mutex;
+            map_type map;
+        };
+
+        // Shard i holds the keys in [splitters_[i - 1], splitters_[i]).
+        std::vector<Key> splitters_;
+        std::unique_ptr<Shard[]> shards_;
+        size_t shardCount_ = 0;
+        Compare compare_;
+
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename map_type::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type*;
+            using reference = value_type&;
+
+            reference operator*() const
+            {
+                return *iter_;
+            }
+
+            pointer operator->() const
+            {
+                return &*iter_;
+            }
+
+            Iterator& operator++()
+            {
+                ++iter_;
+                skip_empty();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return shard_ == other.shard_
+                        && (shard_ == owner_->shardCount_
+                            || iter_ == other.iter_);
+            }
+
+            bool operator!=(const Iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            friend class ShardedFlatMap;
+
+            Iterator(const ShardedFlatMap* owner, size_t shard)
+                : owner_(owner), shard_(shard)
+            {
+                if (shard_ < owner_->shardCount_) {
+                    iter_ = owner_->shards_[shard_].map.begin();
+                    skip_empty();
+                }
+            }
+
+            void skip_empty()
+            {
+                while (iter_ == owner_->shards_[shard_].map.end()) {
+                    if (++shard_ == owner_->shardCount_) {
+                        return;
+                    }
+                    iter_ = owner_->shards_[shard_].map.begin();
+                }
+            }
+
+            const ShardedFlatMap* owner_;
+            size_t shard_;
+            // FlatMap iterators only dereference when non-const.
+            mutable typename map_type::iterator iter_{nullptr};
+        };
+
+        using iterator = Iterator;
+
+        // A single shard until rebalance() picks boundaries.
+        ShardedFlatMap() : shards_(new Shard[1]), shardCount_(1)
+        {
+        }
+
+        // Up to `shardCount` shards split at quantiles of the sample.
+        template <typename InputIt>
+        ShardedFlatMap(
+                size_t shardCount, InputIt sampleBegin, InputIt sampleEnd)
+        {
+            std::vector<Key> sample(sampleBegin, sampleEnd);
+            std::sort(sample.begin(), sample.end(), compare_);
+            reset(pick_splitters(sample, shardCount, [&](size_t index) {
+                return sample[index];
+            }));
+        }
+
+        ShardedFlatMap(const ShardedFlatMap&) = delete;
+        ShardedFlatMap& operator=(const ShardedFlatMap&) = delete;
+
+        iterator begin() const
+        {
+            return Iterator(this, 0);
+        }
+
+        iterator end() const
+        {
+            return Iterator(this, shardCount_);
+        }
+
+        bool insert(const Key& key, const T& value)
+        {
+            auto& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.map.insert(key, value).second;
+        }
+
+        template <class M>
+        bool insert_or_assign(const Key& key, M&& value)
+        {
+            auto& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.map.insert_or_assign(key, std::forward<M>(value))
+                    .second;
+        }
+
+        size_t erase(const Key& key)
+        {
+            auto& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.map.erase(key);
+        }
+
+        // Returns a copy, since the shard may change once unlocked.
+        std::optional<T> get(const Key& key) const
+        {
+            const auto& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto iter = shard.map.find(key);
+            if (iter == shard.map.end()) {
+                return std::nullopt;
+            }
+            return iter->second;
+        }
+
+        bool contains(const Key& key) const
+        {
+            const auto& shard = shard_for(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.map.contains(key);
+        }
+
+        // Not a consistent snapshot while writers are active.
+        size_t size() const
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < shardCount_; ++i) {
+                std::lock_guard<std::mutex> lock(shards_[i].mutex);
+                total += shards_[i].map.size();
+            }
+            return total;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        size_t shard_count() const
+        {
+            return shardCount_;
+        }
+
+        // Calls `visit` on every element in key order, holding one shard
+        // lock at a time.
+        template <typename Visit>
+        void for_each(Visit&& visit) const
+        {
+            for (size_t i = 0; i < shardCount_; ++i) {
+                std::lock_guard<std::mutex> lock(shards_[i].mutex);
+                for (const auto& element : shards_[i].map) {
+                    visit(element);
+                }
+            }
+        }
+
+        // Like for_each(), restricted to keys in [first, last).
+        template <typename Visit>
+        void for_each_range(const Key& first, const Key& last, Visit&& visit)
+                const
+        {
+            if (!compare_(first, last)) {
+                return;
+            }
+            const size_t lastShard = shard_index(last);
+            for (size_t i = shard_index(first); i <= lastShard; ++i) {
+                std::lock_guard<std::mutex> lock(shards_[i].mutex);
+                const auto& map = shards_[i].map;
+                const auto stop = map.lower_bound(last);
+                for (auto iter = map.lower_bound(first); iter != stop; ++iter) {
+                    visit(*iter);
+                }
+            }
+        }
+
+        // Re-splits the stored elements into `shardCount` shards of equal
+        // size (fewer if there are not enough keys).
+        void rebalance(size_t shardCount)
+        {
+            std::vector<std::pair<Key, T>> elements;
+            elements.reserve(size());
+            for (size_t i = 0; i < shardCount_; ++i) {
+                for (auto& [key, value] : shards_[i].map) {
+                    elements.emplace_back(key, std::move(value));
+                }
+            }
+
+            reset(pick_splitters(elements, shardCount, [&](size_t index) {
+                return elements[index].first;
+            }));
+
+            auto chunk = elements.begin();
+            for (size_t i = 0; i < shardCount_; ++i) {
+                auto stop = i + 1 < shardCount_
+                        ? std::lower_bound(
+                                chunk,
+                                elements.end(),
+                                splitters_[i],
+                                [this](const auto& element, const Key& key) {
+                                    return compare_(element.first, key);
+                                })
+                        : elements.end();
+                shards_[i].map = map_type(
+                        sorted_unique,
+                        std::make_move_iterator(chunk),
+                        std::make_move_iterator(stop));
+                chunk = stop;
+            }
+        }
+
+    private:
+        // Quantiles of a sorted sequence, skipping repeated keys.
+        template <class Sorted, typename KeyAt>
+        std::vector<Key>
+        pick_splitters(const Sorted& sorted, size_t shardCount, KeyAt keyAt)
+                const
+        {
+            std::vector<Key> splitters;
+            for (size_t i = 1; i < shardCount; ++i) {
+                const size_t index = i * sorted.size() / shardCount;
+                if (index == 0) {
+                    continue;
+                }
+                const Key& key = keyAt(index);
+                if (splitters.empty() || compare_(splitters.back(), key)) {
+                    splitters.push_back(key);
+                }
+            }
+            return splitters;
+        }
+
+        void reset(std::vector<Key> splitters)
+        {
+            splitters_ = std::move(splitters);
+            shardCount_ = splitters_.size() + 1;
+            shards_.reset(new Shard[shardCount_]);
+        }
+
+        size_t shard_index(const Key& key) const
+        {
+            return static_cast<size_t>(
+                    std::upper_bound(
+                            splitters_.begin(), splitters_.end(), key, compare_)
+                    - splitters_.begin());
+        }
+
+        Shard& shard_for(const Key& key) const
+        {
+            return shards_[shard_index(key)];
+        }
+    };
+}; // namespace fox
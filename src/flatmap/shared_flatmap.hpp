@@ -0,0 +1,302 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <atomic>
+
+#include <initializer_list>
+
+#include <memory>
+
+#include <utility>
+
+namespace fox {
+
+    // A FlatMap whose copies share one reference-counted buffer, so
+    // copying costs two pointer copies and an atomic increment whatever
+    // the size. The first mutating call on a copy whose storage is
+    // shared duplicates it; clear() just lets go of it.
+    //
+    // Lookups and iteration are const only, return const iterators and
+    // never copy, even on a non-const map, so that `find(key) != end()`
+    // stays cheap. Writing through iterators, like any FlatMap call not
+    // forwarded here, goes through edit(), which copies shared storage
+    // first. The shared map itself is not exposed: FlatMap's const
+    // lookups return mutable iterators. References and
+    // iterators from mutating calls must not be used to write once the
+    // map has been copied.
+    //
+    // Any number of threads may read and copy maps that share storage.
+    // A single SharedFlatMap object is no more thread-safe than a
+    // FlatMap.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            class Allocator = std::allocator<std::pair<const Key, T>>>
+    class SharedFlatMap {
+    public:
+        using map_type = FlatMap<Key, T, Compare, Allocator>;
+        using key_type = typename map_type::key_type;
+        using mapped_type = typename map_type::mapped_type;
+        using value_type = typename map_type::value_type;
+        using size_type = typename map_type::size_type;
+        using iterator = typename map_type::iterator;
+        using const_iterator = typename map_type::const_iterator;
+        using const_reverse_iterator =
+                typename map_type::const_reverse_iterator;
+
+    private:
+        // Null for an empty map that has not been written to.
+        std::shared_ptr<map_type> map_;
+
+    public:
+        SharedFlatMap() = default;
+
+        SharedFlatMap(map_type map)
+            : map_(std::make_shared<map_type>(std::move(map)))
+        {
+        }
+
+        template <typename InputIt>
+        SharedFlatMap(InputIt begin, InputIt end)
+            : SharedFlatMap(map_type(begin, end))
+        {
+        }
+
+        SharedFlatMap(std::initializer_list<value_type> list)
+            : SharedFlatMap(map_type(list))
+        {
+        }
+
+        // The map made private to this object, for mutable iteration and
+        // the rest of the FlatMap interface.
+        map_type& edit()
+        {
+            return mutate();
+        }
+
+        // Whether other copies still share this map's storage.
+        bool is_shared() const
+        {
+            return map_ != nullptr && map_.use_count() > 1;
+        }
+
+        const_iterator begin() const
+        {
+            return get().cbegin();
+        }
+
+        const_iterator end() const
+        {
+            return get().cend();
+        }
+
+        const_iterator cbegin() const
+        {
+            return get().cbegin();
+        }
+
+        const_iterator cend() const
+        {
+            return get().cend();
+        }
+
+        const_reverse_iterator crbegin() const
+        {
+            return get().crbegin();
+        }
+
+        const_reverse_iterator crend() const
+        {
+            return get().crend();
+        }
+
+        size_t size() const
+        {
+            return get().size();
+        }
+
+        bool empty() const
+        {
+            return get().empty();
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            return get().find(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const_iterator find(const K& key) const
+        {
+            return get().find(key);
+        }
+
+        const_iterator lower_bound(const Key& key) const
+        {
+            return get().lower_bound(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const_iterator lower_bound(const K& key) const
+        {
+            return get().lower_bound(key);
+        }
+
+        const_iterator upper_bound(const Key& key) const
+        {
+            return get().upper_bound(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const_iterator upper_bound(const K& key) const
+        {
+            return get().upper_bound(key);
+        }
+
+        std::pair<const_iterator, const_iterator>
+        equal_range(const Key& key) const
+        {
+            return get().equal_range(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        std::pair<const_iterator, const_iterator>
+        equal_range(const K& key) const
+        {
+            return get().equal_range(key);
+        }
+
+        const T& at(const Key& key) const
+        {
+            return get().at(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        const T& at(const K& key) const
+        {
+            return get().at(key);
+        }
+
+        bool contains(const Key& key) const
+        {
+            return get().contains(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        bool contains(const K& key) const
+        {
+            return get().contains(key);
+        }
+
+        size_t count(const Key& key) const
+        {
+            return get().count(key);
+        }
+
+        template <
+                class K,
+                class C = Compare,
+                detail::enable_if_transparent<C> = 0>
+        size_t count(const K& key) const
+        {
+            return get().count(key);
+        }
+
+        T& operator[](const Key& key)
+        {
+            return mutate()[key];
+        }
+
+        std::pair<iterator, bool> insert(const Key& key, const T& value)
+        {
+            return mutate().insert(key, value);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return mutate().insert(value);
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            return mutate().try_emplace(key, std::forward<Args>(args)...);
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value)
+        {
+            return mutate().insert_or_assign(key, std::forward<M>(value));
+        }
+
+        // Erasing a missing key leaves shared storage alone.
+        bool erase(const Key& key)
+        {
+            return contains(key) && mutate().erase(key);
+        }
+
+        template <class Pred>
+        size_t erase_if(Pred pred)
+        {
+            return mutate().erase_if(std::move(pred));
+        }
+
+        void clear()
+        {
+            if (is_shared()) {
+                map_.reset();
+            } else if (map_) {
+                mutate().clear();
+            }
+        }
+
+    private:
+        const map_type& get() const
+        {
+            return map_ ? *map_ : empty_map();
+        }
+
+        map_type& mutate()
+        {
+            if (!map_) {
+                map_ = std::make_shared<map_type>();
+            } else if (map_.use_count() > 1) {
+                // The copy constructor keeps the comparator and any
+                // learned index or prefix cache.
+                map_ = std::make_shared<map_type>(std::as_const(*map_));
+            } else {
+                // Every other owner has released the storage with an
+                // acq_rel decrement; pair it so that their last reads
+                // happen before our writes.
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            return *map_;
+        }
+
+        static const map_type& empty_map()
+        {
+            static const map_type empty;
+            return empty;
+        }
+    };
+}; // namespace fox
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <flatmap.hpp>
+
+#include <initializer_list>
+
+#include <iterator>
+
+#include <new>
+
+#include <stdexcept>
+
+#include <tuple>
+
+#include <utility>
+
+namespace fox {
+
+    // A FlatMap that keeps up to N elements inside the object itself and
+    // searches them linearly, so maps that stay that small never touch
+    // the heap. Inserting element N + 1 moves everything into a regular
+    // FlatMap, which is then used until clear().
+    template <class Key, class T, size_t N, class Compare = std::less<Key>>
+    class SmallFlatMap {
+    public:
+        using map_type = FlatMap<Key, T, Compare>;
+        using key_type = typename map_type::key_type;
+        using mapped_type = typename map_type::mapped_type;
+        using value_type = typename map_type::value_type;
+        using size_type = typename map_type::size_type;
+        using iterator = typename map_type::iterator;
+        using reverse_iterator = typename map_type::reverse_iterator;
+
+        static constexpr size_t inline_capacity = N;
+
+    private:
+        static_assert(N > 0, "SmallFlatMap needs room for one element");
+
+        // As in FlatMap, elements are built with a mutable key so that
+        // shifting can move-assign them.
+        using storage_type = std::pair<Key, T>;
+
+        alignas(value_type) unsigned char buffer_[N * sizeof(value_type)];
+        // Number of inline elements; zero once spilled.
+        size_t size_ = 0;
+        bool spilled_ = false;
+        map_type heap_;
+        Compare compare_;
+
+    public:
+        SmallFlatMap() = default;
+
+        // The destructor does not run for a constructor that throws, so
+        // inline elements built so far are destroyed here.
+        SmallFlatMap(std::initializer_list<value_type> list)
+        {
+            try {
+                for (const auto& value : list) {
+                    insert(value);
+                }
+            } catch (...) {
+                destroy_inline();
+                throw;
+            }
+        }
+
+        SmallFlatMap(const SmallFlatMap& other)
+        {
+            copy_from(other);
+        }
+
+        SmallFlatMap(SmallFlatMap&& other) noexcept(
+                std::is_nothrow_move_constructible_v<value_type>)
+        {
+            move_from(std::move(other));
+        }
+
+        SmallFlatMap& operator=(const SmallFlatMap& other)
+        {
+            if (this != &other) {
+                clear();
+                copy_from(other);
+            }
+            return *this;
+        }
+
+        SmallFlatMap& operator=(SmallFlatMap&& other) noexcept(
+                std::is_nothrow_move_constructible_v<value_type>)
+        {
+            if (this != &other) {
+                clear();
+                move_from(std::move(other));
+            }
+            return *this;
+        }
+
+        ~SmallFlatMap()
+        {
+            destroy_inline();
+        }
+
+        iterator begin() const
+        {
+            return spilled_ ? heap_.begin() : iterator(inline_data());
+        }
+
+        iterator end() const
+        {
+            return spilled_ ? heap_.end() : iterator(inline_data() + size_);
+        }
+
+        reverse_iterator rbegin() const
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend() const
+        {
+            return reverse_iterator(begin());
+        }
+
+        size_t size() const
+        {
+            return spilled_ ? heap_.size() : size_;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        // True while the elements live in the object rather than the heap.
+        bool is_inline() const
+        {
+            return !spilled_;
+        }
+
+        std::pair<iterator, bool> insert(const Key& key, const T& value)
+        {
+            return try_emplace(key, value);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            if (spilled_) {
+                return heap_.try_emplace(key, std::forward<Args>(args)...);
+            }
+
+            value_type* data = inline_data();
+            const size_t index = lower_bound_index(key);
+            if (index < size_ && !compare_(key, data[index].first)) {
+                return {iterator(data + index), false};
+            }
+
+            if (size_ == N) {
+                spill();
+                return heap_.try_emplace(key, std::forward<Args>(args)...);
+            }
+
+            insert_inline(
+                    index,
+                    std::piecewise_construct,
+                    std::forward_as_tuple(key),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+            return {iterator(data + index), true};
+        }
+
+        template <class M>
+        std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value)
+        {
+            // try_emplace() leaves `value` alone when the key exists.
+            auto result = try_emplace(key, std::forward<M>(value));
+            if (!result.second) {
+                result.first->second = std::forward<M>(value);
+            }
+            return result;
+        }
+
+        T& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& at(const Key& key)
+        {
+            return at_impl(key);
+        }
+
+        const T& at(const Key& key) const
+        {
+            return at_impl(key);
+        }
+
+        iterator find(const Key& key) const
+        {
+            if (spilled_) {
+                return heap_.find(key);
+            }
+            value_type* data = inline_data();
+            const size_t index = lower_bound_index(key);
+            if (index < size_ && !compare_(key, data[index].first)) {
+                return iterator(data + index);
+            }
+            return end();
+        }
+
+        bool contains(const Key& key) const
+        {
+            return find(key) != end();
+        }
+
+        size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        iterator erase(iterator pos)
+        {
+            if (spilled_) {
+                return heap_.erase(pos);
+            }
+            const auto index = static_cast<size_t>(pos - begin());
+            erase_inline(index);
+            return iterator(inline_data() + index);
+        }
+
+        size_t erase(const Key& key)
+        {
+            const auto iter = find(key);
+            if (iter == end()) {
+                return 0;
+            }
+            erase(iter);
+            return 1;
+        }
+
+        // Also releases the heap buffer of a spilled map, returning it to
+        // inline storage.
+        void clear()
+        {
+            destroy_inline();
+            heap_ = map_type();
+            spilled_ = false;
+        }
+
+    private:
+        value_type* inline_data() const
+        {
+            return std::launder(reinterpret_cast<value_type*>(
+                    const_cast<unsigned char*>(buffer_)));
+        }
+
+        // Position of the first element not less than `key`. A linear scan
+        // beats binary search at these sizes: no unpredictable branches
+        // and all elements sit in a few adjacent cache lines.
+        size_t lower_bound_index(const Key& key) const
+        {
+            const value_type* data = inline_data();
+            size_t index = 0;
+            while (index < size_ && compare_(data[index].first, key)) {
+                ++index;
+            }
+            return index;
+        }
+
+        static storage_type& storage(value_type& element)
+        {
+            return *std::launder(reinterpret_cast<storage_type*>(&element));
+        }
+
+        template <class... Args>
+        void construct(value_type* slot, Args&&... args)
+        {
+            ::new (static_cast<void*>(slot))
+                    storage_type(std::forward<Args>(args)...);
+        }
+
+        void destroy(value_type* slot)
+        {
+            storage(*slot).~storage_type();
+        }
+
+        // The new element is built before anything moves, so a throwing
+        // constructor leaves the map as it was.
+        template <class... Args>
+        void insert_inline(size_t index, Args&&... args)
+        {
+            value_type* data = inline_data();
+            storage_type value(std::forward<Args>(args)...);
+            if (index == size_) {
+                construct(&data[index], std::move(value));
+                ++size_;
+                return;
+            }
+
+            const size_t last = size_;
+            construct(&data[last], std::move(storage(data[last - 1])));
+            ++size_;
+            for (size_t i = last - 1; i > index; --i) {
+                storage(data[i]) = std::move(storage(data[i - 1]));
+            }
+            storage(data[index]) = std::move(value);
+        }
+
+        void erase_inline(size_t index)
+        {
+            value_type* data = inline_data();
+            for (size_t i = index + 1; i < size_; ++i) {
+                storage(data[i - 1]) = std::move(storage(data[i]));
+            }
+            --size_;
+            destroy(&data[size_]);
+        }
+
+        void destroy_inline()
+        {
+            value_type* data = inline_data();
+            for (size_t i = 0; i < size_; ++i) {
+                destroy(&data[i]);
+            }
+            size_ = 0;
+        }
+
+        // Moves the inline elements into a heap map. They are already
+        // sorted and unique, so the map is built without searching.
+        void spill()
+        {
+            value_type* data = inline_data();
+            map_type heap(
+                    sorted_unique,
+                    std::make_move_iterator(data),
+                    std::make_move_iterator(data + size_));
+            destroy_inline();
+            heap_ = std::move(heap);
+            spilled_ = true;
+        }
+
+        void copy_from(const SmallFlatMap& other)
+        {
+            if (other.spilled_) {
+                heap_ = other.heap_;
+                spilled_ = true;
+                return;
+            }
+            const value_type* data = other.inline_data();
+            try {
+                for (; size_ < other.size_; ++size_) {
+                    construct(&inline_data()[size_], data[size_]);
+                }
+            } catch (...) {
+                destroy_inline();
+                throw;
+            }
+        }
+
+        void move_from(SmallFlatMap&& other)
+        {
+            if (other.spilled_) {
+                heap_ = std::move(other.heap_);
+                spilled_ = true;
+                other.clear();
+                return;
+            }
+            value_type* data = other.inline_data();
+            try {
+                for (; size_ < other.size_; ++size_) {
+                    construct(
+                            &inline_data()[size_], std::move(data[size_]));
+                }
+            } catch (...) {
+                destroy_inline();
+                throw;
+            }
+            other.clear();
+        }
+
+        T& at_impl(const Key& key) const
+        {
+            auto iter = find(key);
+            if (iter == end()) {
+                throw std::out_of_range("Key not found in flatmap");
+            }
+            return iter->second;
+        }
+    };
+}; // namespace fox
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <flatmap.hpp>
+#include <flatmap_search.hpp>
+
+#include <array>
+
+#include <cstddef>
+
+#include <functional>
+
+#include <iterator>
+
+#include <stdexcept>
+
+#include <utility>
+
+namespace fox {
+
+    // A map whose N elements are fixed when it is built, as for keyword,
+    // opcode or enum name tables. make_static_flat_map() sorts the entries
+    // and rejects duplicate keys during constant evaluation, so a
+    // constexpr table costs no allocation or static initialization and
+    // lives in read-only data. The lookup and iteration interface matches
+    // FlatMap's const members. For arithmetic keys, find() halves the
+    // range with conditional moves for a number of steps fixed by N, so it
+    // has no data-dependent branches.
+    template <class Key, class T, size_t N, class Compare = std::less<Key>>
+    class StaticFlatMap {
+    public:
+        using key_type = const Key;
+        using mapped_type = T;
+        using value_type = std::pair<key_type, mapped_type>;
+        using key_compare = Compare;
+        using size_type = size_t;
+        using iterator = const value_type*;
+        using const_iterator = const value_type*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = reverse_iterator;
+
+    private:
+        static_assert(N > 0, "StaticFlatMap needs at least one element");
+
+        std::array<value_type, N> data_;
+        Compare compare_;
+
+    public:
+        // Takes elements already sorted by `compare` without duplicates;
+        // throws std::invalid_argument, which fails constant evaluation,
+        // if they are not.
+        constexpr StaticFlatMap(
+                sorted_unique_t /*unused*/,
+                const std::array<value_type, N>& data,
+                const Compare& compare = Compare())
+            : data_(data), compare_(compare)
+        {
+            for (size_t i = 1; i < N; ++i) {
+                if (!compare_(data_[i - 1].first, data_[i].first)) {
+                    throw std::invalid_argument(
+                            "StaticFlatMap: keys not sorted and unique");
+                }
+            }
+        }
+
+        constexpr iterator begin() const
+        {
+            return data_.data();
+        }
+
+        constexpr iterator end() const
+        {
+            return data_.data() + N;
+        }
+
+        constexpr const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        constexpr const_iterator cend() const
+        {
+            return end();
+        }
+
+        constexpr reverse_iterator rbegin() const
+        {
+            return reverse_iterator(end());
+        }
+
+        constexpr reverse_iterator rend() const
+        {
+            return reverse_iterator(begin());
+        }
+
+        constexpr size_t size() const
+        {
+            return N;
+        }
+
+        constexpr bool empty() const
+        {
+            return false;
+        }
+
+        constexpr iterator lower_bound(const Key& key) const
+        {
+            const value_type* base = data_.data();
+            size_t len = N;
+            if constexpr (detail::use_branchless_search<Key, Compare>) {
+                while (len > 1) {
+                    const size_t half = len / 2;
+                    base = compare_(base[half].first, key) ? base + half
+                                                           : base;
+                    len -= half;
+                }
+                return base + (compare_(base->first, key) ? 1 : 0);
+            }
+
+            // Expensive comparisons, e.g. of strings, are better served by
+            // branches the CPU can run ahead on.
+            while (len > 0) {
+                const size_t half = len / 2;
+                if (compare_(base[half].first, key)) {
+                    base += half + 1;
+                    len -= half + 1;
+                } else {
+                    len = half;
+                }
+            }
+            return base;
+        }
+
+        constexpr iterator find(const Key& key) const
+        {
+            const iterator iter = lower_bound(key);
+            if (iter != end() && !compare_(key, iter->first)) {
+                return iter;
+            }
+            return end();
+        }
+
+        constexpr bool contains(const Key& key) const
+        {
+            return find(key) != end();
+        }
+
+        constexpr size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        constexpr const T& at(const Key& key) const
+        {
+            const iterator iter = find(key);
+            if (iter == end()) {
+                throw std::out_of_range("Key not found in flatmap");
+            }
+            return iter->second;
+        }
+    };
+
+    namespace detail {
+
+        // Indices of `entries` in key order, sorted by insertion sort,
+        // which constant evaluation handles for tables of a few thousand
+        // entries.
+        template <class Key, class T, size_t N, class Compare>
+        constexpr std::array<size_t, N> static_order(
+                const std::pair<Key, T> (&entries)[N], const Compare& compare)
+        {
+            std::array<size_t, N> order{};
+            for (size_t i = 0; i < N; ++i) {
+                size_t j = i;
+                for (; j > 0
+                     && compare(entries[i].first, entries[order[j - 1]].first);
+                     --j) {
+                    order[j] = order[j - 1];
+                }
+                order[j] = i;
+            }
+            return order;
+        }
+
+        template <class Key, class T, size_t N, size_t... I>
+        constexpr std::array<std::pair<const Key, T>, N> static_gather(
+                const std::pair<Key, T> (&entries)[N],
+                const std::array<size_t, N>& order,
+                std::index_sequence<I...> /*unused*/)
+        {
+            return {{std::pair<const Key, T>(entries[order[I]])...}};
+        }
+    }; // namespace detail
+
+    // Builds a StaticFlatMap from entries in any order, e.g.
+    //
+    //     constexpr auto opcodes = fox::make_static_flat_map<
+    //             std::string_view, int>({{"add", 1}, {"sub", 2}});
+    //
+    // Duplicate keys make the StaticFlatMap constructor throw
+    // std::invalid_argument, a compile error when the table is constexpr.
+    template <
+            class Key,
+            class T,
+            class Compare = std::less<Key>,
+            size_t N>
+    constexpr StaticFlatMap<Key, T, N, Compare> make_static_flat_map(
+            const std::pair<Key, T> (&entries)[N],
+            const Compare& compare = Compare())
+    {
+        const auto order = detail::static_order(entries, compare);
+        return StaticFlatMap<Key, T, N, Compare>(
+                sorted_unique,
+                detail::static_gather(
+                        entries, order, std::make_index_sequence<N>()),
+                compare);
+    }
+}; // namespace fox
@@ -0,0 +1,176 @@
+#include <buffered_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(BufferedFlatMap, BuffersWrites)
+{
+    fox::BufferedFlatMap<int, std::string> mymap(8);
+    ASSERT_TRUE(mymap.insert(3, "c"));
+    ASSERT_TRUE(mymap.insert(1, "a"));
+    ASSERT_TRUE(mymap.insert_or_assign(2, "b"));
+    ASSERT_FALSE(mymap.insert(3, "x"));
+    mymap[4] = "d";
+
+    ASSERT_EQ(mymap.pending(), 4);
+    ASSERT_EQ(mymap.size(), 4);
+    ASSERT_TRUE(mymap.contains(2));
+    ASSERT_EQ(mymap.at(3), "c");
+    ASSERT_THROW(mymap.at(5), std::out_of_range);
+
+    std::vector<int> keys;
+    for (const auto& pair : mymap) {
+        keys.push_back(pair.first);
+    }
+    ASSERT_EQ(keys, (std::vector<int>{1, 2, 3, 4}));
+    ASSERT_EQ(mymap.pending(), 0);
+}
+
+TEST(BufferedFlatMap, FlushesAtLimit)
+{
+    fox::BufferedFlatMap<int, int> mymap(4);
+    for (int key = 0; key < 3; ++key) {
+        mymap.insert(key, key);
+    }
+    ASSERT_EQ(mymap.pending(), 3);
+
+    // The fourth write fills the buffer and merges it, so the reference
+    // returned by operator[] has to point into the main array.
+    int& value = mymap[10];
+    ASSERT_EQ(mymap.pending(), 0);
+    value = 42;
+    ASSERT_EQ(mymap.at(10), 42);
+}
+
+TEST(BufferedFlatMap, Tombstones)
+{
+    fox::BufferedFlatMap<int, int> mymap(16);
+    mymap.insert(1, 10);
+    mymap.insert(2, 20);
+    mymap.flush();
+
+    ASSERT_EQ(mymap.erase(1), 1);
+    ASSERT_EQ(mymap.erase(1), 0);
+    ASSERT_FALSE(mymap.contains(1));
+    ASSERT_THROW(mymap.at(1), std::out_of_range);
+    ASSERT_EQ(mymap.size(), 1);
+
+    ASSERT_TRUE(mymap.insert(1, 11));
+    ASSERT_EQ(mymap.at(1), 11);
+    ASSERT_EQ(mymap.erase(1), 1);
+    ASSERT_EQ(mymap.erase(3), 0);
+    ASSERT_EQ(mymap.pending(), 1);
+
+    ASSERT_EQ(mymap.find(1), mymap.end());
+    ASSERT_EQ(mymap.find(2)->second, 20);
+    ASSERT_EQ(mymap.size(), 1);
+}
+
+TEST(BufferedFlatMap, FindBeforeOrAfterEnd)
+{
+    fox::BufferedFlatMap<int, int> mymap;
+    mymap.insert(1, 1);
+    ASSERT_TRUE(mymap.find(1) != mymap.end());
+    mymap.insert(2, 2);
+    ASSERT_TRUE(mymap.end() != mymap.find(2));
+    mymap.erase(1);
+    ASSERT_TRUE(mymap.end() == mymap.find(1));
+}
+
+TEST(BufferedFlatMap, MatchesStdMap)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> keyDist(0, 200);
+    std::uniform_int_distribution<int> opDist(0, 5);
+
+    fox::BufferedFlatMap<int, int> mymap(5);
+    std::map<int, int> expected;
+    for (int step = 0; step < 5000; ++step) {
+        const int key = keyDist(rng);
+        switch (opDist(rng)) {
+        case 0:
+            ASSERT_EQ(mymap.insert(key, step),
+                      expected.emplace(key, step).second);
+            break;
+        case 1:
+            ASSERT_EQ(mymap.insert_or_assign(key, step),
+                      expected.insert_or_assign(key, step).second);
+            break;
+        case 2:
+            mymap[key] += step;
+            expected[key] += step;
+            break;
+        case 3:
+        case 4:
+            ASSERT_EQ(mymap.erase(key), expected.erase(key));
+            break;
+        default:
+            ASSERT_EQ(mymap.count(key), expected.count(key));
+            break;
+        }
+        ASSERT_EQ(mymap.size(), expected.size());
+    }
+
+    const auto merged = std::move(mymap).extract();
+    ASSERT_TRUE(std::equal(
+            merged.begin(), merged.end(), expected.begin(), expected.end()));
+}
+
+TEST(BufferedFlatMap, ConstReadsDoNotMerge)
+{
+    fox::BufferedFlatMap<int, int> mymap(1000);
+    for (int key = 0; key < 500; ++key) {
+        mymap.insert(key, key * 2);
+    }
+    mymap.flush();
+    for (int key = 500; key < 600; ++key) {
+        mymap.insert(key, key * 2);
+    }
+    mymap.erase(7);
+
+    // Readers through a const reference share the map without locking.
+    const auto& shared = mymap;
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&shared] {
+            for (int key = 0; key < 600; ++key) {
+                ASSERT_EQ(shared.contains(key), key != 7);
+                if (key != 7) {
+                    ASSERT_EQ(shared.at(key), key * 2);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(shared.pending(), 101);
+    ASSERT_EQ(shared.size(), 599);
+}
+
+TEST(BufferedFlatMap, ConstIterationAfterFlush)
+{
+    fox::BufferedFlatMap<int, int> mymap;
+    for (int key = 0; key < 10; ++key) {
+        mymap.insert(key, key * 2);
+    }
+    mymap.erase(3);
+    mymap.flush();
+
+    const auto& shared = mymap;
+    ASSERT_EQ(std::distance(shared.begin(), shared.end()), 9);
+    ASSERT_EQ(shared.rbegin()->first, 9);
+    ASSERT_EQ(shared.find(4)->second, 8);
+    ASSERT_EQ(shared.find(3), shared.end());
+    ASSERT_EQ(shared.lower_bound(3)->first, 4);
+    ASSERT_EQ(shared.upper_bound(4)->first, 5);
+    const auto [first, last] = shared.equal_range(5);
+    ASSERT_EQ(std::distance(first, last), 1);
+}
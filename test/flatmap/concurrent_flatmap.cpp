@@ -0,0 +1,106 @@
+#include <concurrent_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentFlatMap, UpdateAndRead)
+{
+    fox::ConcurrentFlatMap<int, int> mymap;
+    const auto reader = mymap.reader();
+
+    ASSERT_TRUE(reader.pin()->empty());
+
+    mymap.update([](auto& map) {
+        map.insert(1, 10);
+        map.insert(2, 20);
+    });
+
+    const auto snapshot = reader.pin();
+    ASSERT_EQ(snapshot->size(), 2);
+    ASSERT_EQ(snapshot->at(2), 20);
+    ASSERT_EQ(snapshot->find(3), snapshot->end());
+}
+
+TEST(ConcurrentFlatMap, SnapshotIsolation)
+{
+    fox::ConcurrentFlatMap<int, int> mymap(
+            fox::FlatMap<int, int>{{1, 1}, {2, 2}});
+    const auto reader = mymap.reader();
+
+    {
+        const auto snapshot = reader.pin();
+        mymap.update([](auto& map) { map.erase(1); });
+        mymap.store(fox::FlatMap<int, int>{{5, 5}});
+
+        ASSERT_EQ(snapshot->size(), 2);
+        ASSERT_EQ(snapshot->at(1), 1);
+        ASSERT_EQ(mymap.retired(), 2);
+    }
+
+    mymap.reclaim();
+    ASSERT_EQ(mymap.retired(), 0);
+    ASSERT_EQ(reader.pin()->begin()->first, 5);
+}
+
+TEST(ConcurrentFlatMap, ReaderSlots)
+{
+    fox::ConcurrentFlatMap<int, int> mymap(2);
+    auto first = mymap.reader();
+    {
+        const auto second = mymap.reader();
+        ASSERT_THROW(mymap.reader(), std::length_error);
+    }
+    const auto third = mymap.reader();
+    const auto moved = std::move(first);
+    ASSERT_THROW(mymap.reader(), std::length_error);
+}
+
+TEST(ConcurrentFlatMap, ConcurrentReadersSeeWholeBatches)
+{
+    fox::ConcurrentFlatMap<int, int> mymap;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    // Every published snapshot holds keys 0..9 mapped to one version.
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            const auto reader = mymap.reader();
+            while (!done.load()) {
+                const auto snapshot = reader.pin();
+                if (snapshot->empty()) {
+                    continue;
+                }
+                const int version = snapshot->begin()->second;
+                for (const auto& [key, value] : *snapshot) {
+                    if (value != version) {
+                        consistent = false;
+                    }
+                }
+                if (snapshot->size() != 10) {
+                    consistent = false;
+                }
+            }
+        });
+    }
+
+    for (int version = 0; version < 1000; ++version) {
+        mymap.update([version](auto& map) {
+            for (int key = 0; key < 10; ++key) {
+                map.insert_or_assign(key, version);
+            }
+        });
+    }
+    done = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    ASSERT_TRUE(consistent.load());
+    mymap.reclaim();
+    ASSERT_EQ(mymap.retired(), 0);
+}
@@ -4,9 +4,15 @@
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <map>
+#include <vector>
 
 TEST(FlatMap, SimpleCheck)
 {
@@ -251,3 +257,581 @@ TEST(FlatMap, Algoritm3)
 
     ASSERT_EQ(iter->first, 3);
 }
+
+TEST(FlatMap, Reserve)
+{
+    fox::FlatMap<int, int> mymap(10);
+
+    ASSERT_EQ(mymap.capacity(), 10);
+    ASSERT_TRUE(mymap.empty());
+
+    mymap.reserve(5);
+    ASSERT_EQ(mymap.capacity(), 10);
+
+    mymap.reserve(20);
+    ASSERT_EQ(mymap.capacity(), 20);
+}
+
+TEST(FlatMap, CapacityGrowth)
+{
+    fox::FlatMap<int, int> mymap;
+    size_t reallocations = 0;
+    size_t capacity = mymap.capacity();
+    for (int i = 0; i < 1000; ++i) {
+        mymap.insert((i * 7919) % 1000, i);
+        if (mymap.capacity() != capacity) {
+            capacity = mymap.capacity();
+            ++reallocations;
+        }
+    }
+
+    ASSERT_EQ(mymap.size(), 1000);
+    ASSERT_LE(reallocations, 11);
+    ASSERT_TRUE(std::is_sorted(
+            mymap.begin(), mymap.end(), [](auto& lhs, auto& rhs) {
+                return lhs.first < rhs.first;
+            }));
+}
+
+TEST(FlatMap, ShrinkToFit)
+{
+    fox::FlatMap<std::string, int> mymap(16);
+    mymap.insert("foo", 100);
+    mymap.insert("bar", 200);
+    mymap.shrink_to_fit();
+
+    ASSERT_EQ(mymap.capacity(), 2);
+    ASSERT_EQ(mymap.at("foo"), 100);
+    ASSERT_EQ(mymap.at("bar"), 200);
+}
+
+TEST(FlatMap, EraseKeepsCapacity)
+{
+    fox::FlatMap<std::string, int> mymap;
+    mymap.insert("foo", 100);
+    mymap.insert("bar", 200);
+    mymap.insert("bee", 300);
+    const size_t capacity = mymap.capacity();
+    mymap.erase("bee");
+
+    ASSERT_EQ(mymap.capacity(), capacity);
+    ASSERT_EQ(mymap.size(), 2);
+    ASSERT_EQ(mymap.begin()->first, "bar");
+    ASSERT_EQ((mymap.begin() + 1)->first, "foo");
+}
+
+TEST(FlatMap, RangeConstructorSorts)
+{
+    const std::vector<std::pair<int, int>> items
+            = {{3, 300}, {1, 100}, {2, 200}, {5, 500}, {4, 400}};
+    const fox::FlatMap<int, int> mymap(items.begin(), items.end());
+
+    ASSERT_EQ(mymap.size(), 5);
+    ASSERT_EQ(mymap.capacity(), 5);
+    int expected = 1;
+    for (const auto& pair : mymap) {
+        ASSERT_EQ(pair.first, expected);
+        ASSERT_EQ(pair.second, expected * 100);
+        ++expected;
+    }
+}
+
+TEST(FlatMap, RangeConstructorKeepsFirstDuplicate)
+{
+    const fox::FlatMap<std::string, int> mymap
+            = {{"foo", 100}, {"bar", 200}, {"foo", 300}, {"bar", 400}};
+
+    ASSERT_EQ(mymap.size(), 2);
+    ASSERT_EQ(mymap.at("foo"), 100);
+    ASSERT_EQ(mymap.at("bar"), 200);
+}
+
+TEST(FlatMap, SortedUniqueConstructor)
+{
+    const std::map<std::string, int> map
+            = {{"foo", 100}, {"bar", 200}, {"bee", 300}};
+    const fox::FlatMap<std::string, int> mymap1(
+            fox::sorted_unique, map.begin(), map.end());
+    const fox::FlatMap<int, int> mymap2(
+            fox::sorted_unique, {{1, 100}, {2, 200}, {3, 300}});
+
+    ASSERT_EQ(mymap1.size(), 3);
+    ASSERT_EQ(mymap1.at("bar"), 200);
+    ASSERT_EQ(mymap1.begin()->first, "bar");
+    ASSERT_EQ(mymap2.at(3), 300);
+}
+
+TEST(FlatMap, InsertRange)
+{
+    fox::FlatMap<int, int> mymap = {{1, 100}, {3, 300}, {5, 500}};
+    const std::vector<std::pair<int, int>> batch
+            = {{4, 400}, {3, 0}, {0, 0}, {6, 600}, {0, 1}};
+    mymap.insert_range(batch.begin(), batch.end());
+
+    const std::map<int, int> expected
+            = {{0, 0}, {1, 100}, {3, 300}, {4, 400}, {5, 500}, {6, 600}};
+    ASSERT_TRUE(std::equal(
+            mymap.begin(),
+            mymap.end(),
+            expected.begin(),
+            expected.end(),
+            [](auto& lhs, auto& rhs) {
+                return lhs.first == rhs.first && lhs.second == rhs.second;
+            }));
+}
+
+TEST(FlatMap, InsertOrAssignRange)
+{
+    fox::FlatMap<std::string, int> mymap = {{"foo", 100}, {"bar", 200}};
+    mymap.reserve(8);
+    const std::vector<std::pair<std::string, int>> batch
+            = {{"bee", 300}, {"foo", 400}, {"bee", 500}};
+    mymap.insert_or_assign_range(batch.begin(), batch.end());
+
+    ASSERT_EQ(mymap.size(), 3);
+    ASSERT_EQ(mymap.capacity(), 8);
+    ASSERT_EQ(mymap.at("foo"), 400);
+    ASSERT_EQ(mymap.at("bar"), 200);
+    ASSERT_EQ(mymap.at("bee"), 500);
+}
+
+TEST(FlatMap, InsertRangeCombine)
+{
+    fox::FlatMap<std::string, int> mymap = {{"foo", 1}, {"bar", 2}};
+    const std::vector<std::pair<std::string, int>> batch
+            = {{"foo", 10}, {"bee", 20}, {"foo", 100}};
+    mymap.insert_range(
+            batch.begin(), batch.end(), [](int& existing, int&& incoming) {
+                existing += incoming;
+            });
+
+    ASSERT_EQ(mymap.at("foo"), 111);
+    ASSERT_EQ(mymap.at("bar"), 2);
+    ASSERT_EQ(mymap.at("bee"), 20);
+}
+
+TEST(FlatMap, Merge)
+{
+    fox::FlatMap<int, int> mymap1 = {{1, 100}, {2, 200}};
+    fox::FlatMap<int, int> mymap2 = {{2, 0}, {3, 300}};
+    mymap1.merge(std::move(mymap2));
+
+    ASSERT_EQ(mymap1.size(), 3);
+    ASSERT_EQ(mymap1.at(2), 200);
+    ASSERT_EQ(mymap1.at(3), 300);
+
+    fox::FlatMap<int, int> mymap3 = {{1, 1}, {4, 400}};
+    mymap1.merge(std::move(mymap3), fox::overwrite);
+
+    ASSERT_EQ(mymap1.size(), 4);
+    ASSERT_EQ(mymap1.at(1), 1);
+    ASSERT_EQ(mymap1.at(4), 400);
+}
+
+namespace {
+
+    // Counts key constructions so tests can prove lookups allocate nothing.
+    struct CountingKey {
+        static inline int constructions = 0;
+
+        std::string value;
+
+        CountingKey(std::string_view view) : value(view)
+        {
+            ++constructions;
+        }
+    };
+
+    struct CountingLess {
+        using is_transparent = void;
+
+        bool operator()(const CountingKey& lhs, const CountingKey& rhs) const
+        {
+            return lhs.value < rhs.value;
+        }
+        bool operator()(const CountingKey& lhs, std::string_view rhs) const
+        {
+            return lhs.value < rhs;
+        }
+        bool operator()(std::string_view lhs, const CountingKey& rhs) const
+        {
+            return lhs < rhs.value;
+        }
+    };
+
+} // namespace
+
+TEST(FlatMap, TransparentLookup)
+{
+    fox::FlatMap<CountingKey, int, CountingLess> mymap
+            = {{CountingKey("foo"), 100},
+               {CountingKey("bar"), 200},
+               {CountingKey("bee"), 300}};
+    const int constructions = CountingKey::constructions;
+    const std::string_view bar = "bar";
+
+    ASSERT_EQ(mymap.at(bar), 200);
+    ASSERT_EQ(mymap.find(std::string_view("bee"))->second, 300);
+    ASSERT_TRUE(mymap.contains(std::string_view("foo")));
+    ASSERT_EQ(mymap.count(std::string_view("baz")), 0);
+    ASSERT_EQ(mymap.lower_bound(std::string_view("baz"))->first.value, "bee");
+    ASSERT_EQ(mymap.upper_bound(bar)->first.value, "bee");
+    ASSERT_EQ(
+            mymap.equal_range(bar).second - mymap.equal_range(bar).first, 1);
+    ASSERT_TRUE(mymap.erase(bar));
+    ASSERT_FALSE(mymap.erase(bar));
+    ASSERT_EQ(CountingKey::constructions, constructions);
+}
+
+TEST(FlatMap, TransparentStdLess)
+{
+    fox::FlatMap<std::string, int, std::less<>> mymap
+            = {{"foo", 100}, {"bar", 200}};
+
+    ASSERT_EQ(mymap.at("foo"), 100);
+    ASSERT_EQ(mymap.at(std::string_view("bar")), 200);
+    ASSERT_EQ(mymap.count("bee"), 0);
+}
+
+TEST(FlatMap, Bounds)
+{
+    const fox::FlatMap<int, int> mymap = {{10, 1}, {20, 2}, {30, 3}};
+
+    ASSERT_EQ(mymap.lower_bound(20)->first, 20);
+    ASSERT_EQ(mymap.upper_bound(20)->first, 30);
+    ASSERT_EQ(mymap.lower_bound(15)->first, 20);
+    ASSERT_EQ(mymap.upper_bound(30), mymap.end());
+    ASSERT_EQ(mymap.equal_range(25).first, mymap.equal_range(25).second);
+    ASSERT_EQ(mymap.count(10), 1);
+}
+
+TEST(FlatMap, FindBatch)
+{
+    for (int size = 0; size < 100; ++size) {
+        fox::FlatMap<int, int> mymap;
+        for (int i = 0; i < size; ++i) {
+            mymap.insert(i * 2, i);
+        }
+
+        std::vector<int> keys;
+        for (int key = -1; key <= size * 2; ++key) {
+            keys.push_back(key);
+        }
+        std::reverse(keys.begin(), keys.end());
+
+        std::vector<fox::FlatMap<int, int>::iterator> found;
+        mymap.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+
+        ASSERT_EQ(found.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ASSERT_EQ(found[i], mymap.find(keys[i]));
+        }
+    }
+}
+
+TEST(FlatMap, ContainsBatch)
+{
+    const fox::FlatMap<std::string, int> mymap
+            = {{"bar", 1}, {"baz", 2}, {"foo", 3}};
+    const std::string keys[] = {"foo", "qux", "bar", "", "baz", "fooo"};
+    bool found[6] = {};
+
+    auto end = mymap.contains_batch(std::begin(keys), std::end(keys), found);
+
+    ASSERT_EQ(end, std::end(found));
+    ASSERT_TRUE(found[0]);
+    ASSERT_FALSE(found[1]);
+    ASSERT_TRUE(found[2]);
+    ASSERT_FALSE(found[3]);
+    ASSERT_TRUE(found[4]);
+    ASSERT_FALSE(found[5]);
+}
+
+TEST(FlatMap, InsertReportsDuplicate)
+{
+    fox::FlatMap<std::string, int> mymap;
+    auto first = mymap.insert("foo", 100);
+    auto second = mymap.insert("foo", 200);
+
+    ASSERT_TRUE(first.second);
+    ASSERT_FALSE(second.second);
+    ASSERT_EQ(second.first->second, 100);
+}
+
+TEST(FlatMap, Emplace)
+{
+    fox::FlatMap<std::string, std::string> mymap;
+    auto result = mymap.emplace("foo", std::string(3, 'x'));
+
+    ASSERT_TRUE(result.second);
+    ASSERT_EQ(result.first->first, "foo");
+
+    mymap.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple("bar"),
+            std::forward_as_tuple(2, 'y'));
+
+    ASSERT_EQ(mymap.at("foo"), "xxx");
+    ASSERT_EQ(mymap.at("bar"), "yy");
+    ASSERT_FALSE(mymap.emplace("foo", "zzz").second);
+}
+
+TEST(FlatMap, MoveOnlyValues)
+{
+    fox::FlatMap<int, std::unique_ptr<int>> mymap;
+    for (int i = 0; i < 100; ++i) {
+        mymap.try_emplace(99 - i, std::make_unique<int>(i));
+    }
+    mymap.insert_or_assign(5, std::make_unique<int>(500));
+    mymap.insert(std::make_pair(100, std::make_unique<int>(1000)));
+    mymap[101] = std::make_unique<int>(1010);
+    mymap.erase(0);
+
+    ASSERT_EQ(mymap.size(), 101);
+    ASSERT_EQ(*mymap.at(1), 98);
+    ASSERT_EQ(*mymap.at(5), 500);
+    ASSERT_EQ(*mymap.at(100), 1000);
+    ASSERT_EQ(*mymap.at(101), 1010);
+}
+
+TEST(FlatMap, TryEmplaceKeepsArguments)
+{
+    fox::FlatMap<std::string, std::unique_ptr<int>> mymap;
+    mymap.try_emplace("foo", std::make_unique<int>(100));
+    auto value = std::make_unique<int>(200);
+    auto result = mymap.try_emplace("foo", std::move(value));
+
+    ASSERT_FALSE(result.second);
+    ASSERT_NE(value, nullptr);
+    ASSERT_EQ(*mymap.at("foo"), 100);
+}
+
+TEST(FlatMap, EraseRange)
+{
+    fox::FlatMap<int, std::string> mymap;
+    for (int i = 0; i < 10; ++i) {
+        mymap.insert(i, std::to_string(i));
+    }
+    const size_t capacity = mymap.capacity();
+
+    auto iter = mymap.erase(mymap.lower_bound(2), mymap.lower_bound(7));
+
+    ASSERT_EQ(iter->first, 7);
+    ASSERT_EQ(mymap.size(), 5);
+    ASSERT_EQ(mymap.capacity(), capacity);
+    ASSERT_FALSE(mymap.contains(4));
+    ASSERT_EQ(mymap.at(9), "9");
+
+    iter = mymap.erase(mymap.begin());
+    ASSERT_EQ(iter->first, 1);
+    ASSERT_EQ(mymap.erase(mymap.begin(), mymap.begin()), mymap.begin());
+    iter = mymap.erase(mymap.begin(), mymap.end());
+    ASSERT_EQ(iter, mymap.end());
+    ASSERT_TRUE(mymap.empty());
+}
+
+TEST(FlatMap, EraseIf)
+{
+    fox::FlatMap<int, std::string> mymap;
+    for (int i = 0; i < 10; ++i) {
+        mymap.insert(i, std::to_string(i));
+    }
+
+    const size_t removed = mymap.erase_if(
+            [](const auto& pair) { return pair.first % 3 == 0; });
+
+    ASSERT_EQ(removed, 4);
+    ASSERT_EQ(mymap.size(), 6);
+    ASSERT_EQ(mymap.begin()->second, "1");
+    ASSERT_EQ((mymap.begin() + 2)->second, "4");
+    ASSERT_FALSE(mymap.contains(9));
+}
+
+namespace {
+
+    // Stateful allocator that counts live allocations in a shared counter.
+    template <class T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        std::shared_ptr<int> live = std::make_shared<int>(0);
+
+        CountingAllocator() = default;
+
+        template <class U>
+        CountingAllocator(const CountingAllocator<U>& other) : live(other.live)
+        {
+        }
+
+        T* allocate(size_t count)
+        {
+            ++*live;
+            return std::allocator<T>().allocate(count);
+        }
+
+        void deallocate(T* data, size_t count)
+        {
+            --*live;
+            std::allocator<T>().deallocate(data, count);
+        }
+
+        friend bool
+        operator==(const CountingAllocator& lhs, const CountingAllocator& rhs)
+        {
+            return lhs.live == rhs.live;
+        }
+
+        friend bool
+        operator!=(const CountingAllocator& lhs, const CountingAllocator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+} // namespace
+
+TEST(FlatMap, CustomAllocator)
+{
+    using Alloc = CountingAllocator<std::pair<const int, int>>;
+    const Alloc alloc;
+    {
+        fox::FlatMap<int, int, std::less<int>, Alloc> mymap(alloc);
+        for (int i = 0; i < 100; ++i) {
+            mymap.insert(i, i);
+        }
+        ASSERT_EQ(*alloc.live, 1);
+
+        auto copy = mymap;
+        ASSERT_EQ(copy.get_allocator(), alloc);
+        ASSERT_EQ(*alloc.live, 2);
+        ASSERT_EQ(copy.at(42), 42);
+    }
+    ASSERT_EQ(*alloc.live, 0);
+}
+
+TEST(FlatMap, PmrAllocator)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    fox::pmr::FlatMap<int, std::pmr::string> mymap(&arena);
+    mymap.insert(1, "a long value that does not fit into the small buffer");
+    mymap[2] = "another long value that does not fit into the buffer";
+
+    ASSERT_EQ(mymap.get_allocator().resource(), &arena);
+    ASSERT_EQ(mymap.at(1).get_allocator().resource(), &arena);
+
+    const fox::pmr::FlatMap<int, std::pmr::string> copy(mymap);
+    ASSERT_EQ(
+            copy.get_allocator().resource(),
+            std::pmr::get_default_resource());
+    ASSERT_EQ(copy.at(2), mymap.at(2));
+}
+
+TEST(FlatMap, MoveAssignUnequalAllocators)
+{
+    std::pmr::monotonic_buffer_resource arena1;
+    std::pmr::monotonic_buffer_resource arena2;
+    fox::pmr::FlatMap<int, int> mymap1({{1, 100}, {2, 200}}, &arena1);
+    fox::pmr::FlatMap<int, int> mymap2(&arena2);
+
+    mymap2 = std::move(mymap1);
+
+    ASSERT_EQ(mymap2.get_allocator().resource(), &arena2);
+    ASSERT_EQ(mymap2.size(), 2);
+    ASSERT_EQ(mymap2.at(2), 200);
+}
+
+namespace {
+
+    // Counts its copies and throws from the copy that finds copiesLeft at
+    // zero. The move constructor is not noexcept, so reallocation copies.
+    struct FragileKey {
+        static inline int copies = 0;
+        static inline int copiesLeft = -1;
+
+        int value;
+
+        FragileKey(int value) : value(value)
+        {
+        }
+
+        FragileKey(const FragileKey& other) : value(other.value)
+        {
+            if (copiesLeft-- == 0) {
+                throw std::runtime_error("copy failed");
+            }
+            ++copies;
+        }
+
+        FragileKey(FragileKey&& other) : value(other.value)
+        {
+        }
+
+        FragileKey& operator=(const FragileKey& other) = default;
+        FragileKey& operator=(FragileKey&& other) = default;
+
+        bool operator<(const FragileKey& other) const
+        {
+            return value < other.value;
+        }
+    };
+
+    std::vector<int> keys_of(const fox::FlatMap<FragileKey, int>& map)
+    {
+        std::vector<int> keys;
+        for (const auto& pair : map) {
+            keys.push_back(pair.first.value);
+        }
+        return keys;
+    }
+
+} // namespace
+
+TEST(FlatMap, ShiftMovesKeys)
+{
+    FragileKey::copiesLeft = -1;
+    fox::FlatMap<FragileKey, int> mymap;
+    mymap.reserve(101);
+    for (int i = 1; i <= 100; ++i) {
+        mymap.insert(i, i);
+    }
+
+    // Only the inserted key is copied; the shifted ones are moved.
+    FragileKey::copies = 0;
+    mymap.insert(0, 0);
+    ASSERT_EQ(FragileKey::copies, 1);
+    mymap.erase(FragileKey(0));
+    mymap.erase_if([](const auto& pair) { return pair.second % 2 == 0; });
+    ASSERT_EQ(FragileKey::copies, 1);
+
+    ASSERT_EQ(mymap.size(), 50);
+    ASSERT_EQ(mymap.begin()->first.value, 1);
+    ASSERT_EQ(mymap.rbegin()->first.value, 99);
+}
+
+TEST(FlatMap, ThrowingInsertLeavesMapIntact)
+{
+    FragileKey::copiesLeft = -1;
+    fox::FlatMap<FragileKey, int> mymap;
+    for (int i = 0; i < 8; ++i) {
+        mymap.insert(i * 2, i);
+    }
+    mymap.shrink_to_fit();
+    const auto keys = keys_of(mymap);
+
+    // The new key and three relocations succeed, then a copy into the
+    // grown buffer throws.
+    FragileKey::copiesLeft = 4;
+    ASSERT_THROW(mymap.insert(5, 5), std::runtime_error);
+    FragileKey::copiesLeft = -1;
+    ASSERT_EQ(keys_of(mymap), keys);
+
+    mymap.reserve(16);
+    FragileKey::copiesLeft = 0;
+    ASSERT_THROW(mymap.insert(5, 5), std::runtime_error);
+    FragileKey::copiesLeft = -1;
+    ASSERT_EQ(keys_of(mymap), keys);
+
+    mymap.insert(5, 5);
+    ASSERT_EQ(mymap.size(), 9);
+    ASSERT_EQ(mymap.at(5), 5);
+}
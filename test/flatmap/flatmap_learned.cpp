@@ -0,0 +1,123 @@
+#include <flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // Checks lower_bound() with the index against a plain binary search
+    // for every key and for the points around it.
+    template <class Key>
+    void check_against_plain(const std::set<Key>& keys, size_t epsilon)
+    {
+        fox::FlatMap<Key, int> indexed;
+        for (const Key key : keys) {
+            indexed.insert(key, 0);
+        }
+        const fox::FlatMap<Key, int> plain = indexed;
+        indexed.build_learned_index(epsilon);
+        ASSERT_TRUE(indexed.has_learned_index());
+
+        for (const Key key : keys) {
+            for (const Key probe : {Key(key - 1), key, Key(key + 1)}) {
+                const auto expected = plain.lower_bound(probe) - plain.begin();
+                ASSERT_EQ(indexed.lower_bound(probe) - indexed.begin(),
+                          expected);
+            }
+            ASSERT_EQ(indexed.find(key)->first, key);
+        }
+    }
+
+} // namespace
+
+TEST(FlatMapLearned, Uniform)
+{
+    std::mt19937_64 engine(1);
+    std::set<uint64_t> keys;
+    while (keys.size() < 20000) {
+        keys.insert(engine() >> 1);
+    }
+    check_against_plain(keys, 8);
+    check_against_plain(keys, 64);
+}
+
+TEST(FlatMapLearned, SkewedAndClustered)
+{
+    std::mt19937_64 engine(2);
+    std::lognormal_distribution<double> lognormal(0, 2);
+    std::set<int64_t> skewed;
+    while (skewed.size() < 20000) {
+        skewed.insert(static_cast<int64_t>(lognormal(engine) * 1e6));
+    }
+    check_against_plain(skewed, 16);
+
+    std::set<int32_t> clustered;
+    for (int32_t cluster = -50; cluster < 50; ++cluster) {
+        for (int32_t i = 0; i < 100; ++i) {
+            clustered.insert(cluster * 1000000 + i * 3);
+        }
+    }
+    check_against_plain(clustered, 4);
+}
+
+TEST(FlatMapLearned, Doubles)
+{
+    std::set<double> keys;
+    for (int i = 0; i < 5000; ++i) {
+        keys.insert(std::exp(i / 500.0));
+    }
+    check_against_plain(keys, 16);
+}
+
+TEST(FlatMapLearned, SurvivesSmallChanges)
+{
+    fox::FlatMap<uint32_t, uint32_t> mymap;
+    for (uint32_t key = 0; key < 10000; ++key) {
+        mymap.insert(key * 10, key);
+    }
+    mymap.build_learned_index(16);
+
+    // Each change moves elements by one position, within the bound.
+    for (uint32_t key = 0; key < 8; ++key) {
+        mymap.insert(key * 10 + 5, key);
+        mymap.erase(50000 + key * 10);
+    }
+    ASSERT_TRUE(mymap.has_learned_index());
+    for (uint32_t key = 0; key < 100000; key += 5) {
+        const bool present = key % 10 == 0
+                ? key < 50000 || key >= 50080
+                : key < 80;
+        ASSERT_EQ(mymap.contains(key), present) << key;
+    }
+
+    mymap.insert(1, 1);
+    ASSERT_FALSE(mymap.has_learned_index());
+    ASSERT_TRUE(mymap.contains(1));
+}
+
+TEST(FlatMapLearned, CopyAndClear)
+{
+    fox::FlatMap<int, int> mymap;
+    for (int key = 0; key < 1000; ++key) {
+        mymap.insert(key, key);
+    }
+    mymap.build_learned_index();
+    ASSERT_GT(mymap.learned_index_bytes(), 0);
+
+    const auto copy = mymap;
+    ASSERT_TRUE(copy.has_learned_index());
+    ASSERT_EQ(copy.at(500), 500);
+
+    mymap.clear();
+    ASSERT_FALSE(mymap.has_learned_index());
+    ASSERT_EQ(mymap.learned_index_bytes(), 0);
+    mymap.build_learned_index();
+    ASSERT_FALSE(mymap.has_learned_index());
+    ASSERT_EQ(mymap.find(1), mymap.end());
+}
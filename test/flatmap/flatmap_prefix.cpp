@@ -0,0 +1,183 @@
+#include <flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    struct Version {
+        uint32_t major;
+        uint32_t minor;
+        std::string tag;
+
+        bool operator<(const Version& other) const
+        {
+            return std::tie(major, minor, tag)
+                    < std::tie(other.major, other.minor, other.tag);
+        }
+    };
+
+    // Orders versions like operator<, so it may use their key_prefix.
+    struct VersionOrder {
+        bool operator()(const Version& lhs, const Version& rhs) const
+        {
+            return lhs < rhs;
+        }
+    };
+
+    // Random keys drawn from a few long shared prefixes, so that many
+    // prefixes tie and the search has to fall back to the comparator.
+    std::string random_key(std::mt19937& rng)
+    {
+        static const std::vector<std::string> stems
+                = {"", "a", "user:", "user:profile:", "user:session:"};
+        std::string key = stems[rng() % stems.size()];
+        const size_t length = rng() % 6;
+        for (size_t i = 0; i < length; ++i) {
+            key.push_back("ab\xff"[rng() % 3]);
+        }
+        return key;
+    }
+
+} // namespace
+
+template <>
+struct fox::key_prefix<Version> {
+    uint64_t operator()(const Version& version) const
+    {
+        return (uint64_t{version.major} << 32U) | version.minor;
+    }
+};
+
+template <>
+struct fox::key_prefix_agrees<Version, VersionOrder> : std::true_type {};
+
+TEST(FlatMapPrefix, StringPrefixOrder)
+{
+    const fox::key_prefix<std::string> prefix;
+    ASSERT_LT(prefix(""), prefix("a"));
+    ASSERT_LT(prefix("a"), prefix("ab"));
+    ASSERT_LT(prefix("a\x7f"), prefix("a\x80"));
+    ASSERT_LT(prefix("abcdefgh"), prefix("abcdefgi"));
+    ASSERT_EQ(prefix("abcdefgh"), prefix("abcdefghij"));
+    ASSERT_EQ(prefix("a"), prefix(std::string("a\0", 2)));
+
+    const fox::key_prefix<int> intPrefix;
+    ASSERT_LT(intPrefix(-1), intPrefix(0));
+    ASSERT_LT(intPrefix(INT32_MIN), intPrefix(INT32_MAX));
+}
+
+TEST(FlatMapPrefix, MatchesPlainSearch)
+{
+    std::mt19937 rng(3);
+    fox::FlatMap<std::string, int> cached;
+    for (int i = 0; i < 3000; ++i) {
+        cached.insert(random_key(rng), i);
+    }
+    const fox::FlatMap<std::string, int> plain = cached;
+    cached.build_prefix_cache();
+    ASSERT_TRUE(cached.has_prefix_cache());
+    ASSERT_GE(cached.prefix_cache_bytes(), cached.size() * sizeof(uint64_t));
+
+    for (int i = 0; i < 5000; ++i) {
+        const std::string probe = random_key(rng);
+        ASSERT_EQ(cached.lower_bound(probe) - cached.begin(),
+                  plain.lower_bound(probe) - plain.begin());
+        ASSERT_EQ(cached.upper_bound(probe) - cached.begin(),
+                  plain.upper_bound(probe) - plain.begin());
+        ASSERT_EQ(cached.contains(probe), plain.contains(probe));
+    }
+}
+
+TEST(FlatMapPrefix, KeptInStepWithChanges)
+{
+    std::mt19937 rng(4);
+    fox::FlatMap<std::string, int> mymap;
+    std::map<std::string, int> expected;
+    mymap.build_prefix_cache();
+
+    for (int step = 0; step < 4000; ++step) {
+        const std::string key = random_key(rng);
+        switch (rng() % 4) {
+        case 0:
+            mymap[key] = step;
+            expected[key] = step;
+            break;
+        case 1:
+            ASSERT_EQ(mymap.erase(key), expected.erase(key) == 1);
+            break;
+        case 2: {
+            std::vector<std::pair<std::string, int>> batch;
+            for (int i = 0; i < 8; ++i) {
+                batch.emplace_back(random_key(rng), step);
+            }
+            mymap.insert_range(batch.begin(), batch.end());
+            expected.insert(batch.begin(), batch.end());
+            break;
+        }
+        default:
+            ASSERT_EQ(mymap.count(key), expected.count(key));
+            break;
+        }
+    }
+    mymap.erase_if([](const auto& pair) { return pair.second % 3 == 0; });
+    for (auto iter = expected.begin(); iter != expected.end();) {
+        iter = iter->second % 3 == 0 ? expected.erase(iter) : ++iter;
+    }
+
+    const auto copy = mymap;
+    ASSERT_TRUE(copy.has_prefix_cache());
+    for (const auto& [key, value] : expected) {
+        ASSERT_EQ(copy.at(key), value);
+        ASSERT_EQ(mymap.find(key)->second, value);
+    }
+    ASSERT_EQ(mymap.size(), expected.size());
+
+    mymap.clear();
+    ASSERT_FALSE(mymap.has_prefix_cache());
+}
+
+TEST(FlatMapPrefix, CompositeKey)
+{
+    fox::FlatMap<Version, int> versions = {
+            {{1, 2, "beta"}, 0},
+            {{1, 2, "alpha"}, 1},
+            {{1, 10, ""}, 2},
+            {{2, 0, "rc1"}, 3},
+            {{0, 9, ""}, 4}};
+    versions.build_prefix_cache();
+
+    ASSERT_EQ(versions.at({1, 2, "alpha"}), 1);
+    ASSERT_EQ(versions.at({1, 2, "beta"}), 0);
+    ASSERT_FALSE(versions.contains({1, 2, "gamma"}));
+    ASSERT_EQ(versions.lower_bound({1, 3, ""})->second, 2);
+    ASSERT_EQ(versions.upper_bound({1, 2, "beta"})->second, 2);
+    ASSERT_EQ(versions.lower_bound({3, 0, ""}), versions.end());
+}
+
+TEST(FlatMapPrefix, ComparatorMustAgree)
+{
+    // build_prefix_cache() rejects these at compile time: the string
+    // prefix is ascending, so a descending map would miss keys.
+    static_assert(!fox::key_prefix_agrees<
+                  std::string,
+                  std::greater<std::string>>::value);
+    static_assert(!fox::key_prefix_agrees<Version, std::greater<>>::value);
+    static_assert(fox::key_prefix_agrees<std::string, std::less<>>::value);
+
+    fox::FlatMap<Version, int, VersionOrder> versions
+            = {{{2, 0, ""}, 0}, {{1, 5, "rc"}, 1}, {{1, 5, ""}, 2}};
+    versions.build_prefix_cache();
+    ASSERT_TRUE(versions.has_prefix_cache());
+    ASSERT_EQ(versions.at({1, 5, ""}), 2);
+    ASSERT_EQ(versions.begin()->second, 2);
+    ASSERT_FALSE(versions.contains({1, 5, "beta"}));
+}
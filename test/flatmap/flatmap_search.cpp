@@ -0,0 +1,88 @@
+#include <flatmap.hpp>
+#include <flatmap_search.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    template <class Key>
+    void check_lower_bound(size_t size)
+    {
+        std::mt19937_64 engine(size);
+        std::vector<Key> keys(size);
+        for (auto& key : keys) {
+            key = static_cast<Key>(engine() % (size * 4 + 1));
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        for (size_t probe = 0; probe <= size * 4 + 2; ++probe) {
+            const auto key = static_cast<Key>(probe);
+            const auto expected = static_cast<size_t>(
+                    std::lower_bound(keys.begin(), keys.end(), key)
+                    - keys.begin());
+
+            ASSERT_EQ(
+                    fox::detail::lower_bound_index(
+                            keys.data(), keys.size(), key),
+                    expected);
+        }
+    }
+
+} // namespace
+
+TEST(FlatMapSearch, Traits)
+{
+    ASSERT_TRUE((fox::detail::use_branchless_search<int, std::less<int>>));
+    ASSERT_TRUE((fox::detail::use_branchless_search<double, std::less<>>));
+    ASSERT_FALSE((fox::detail::use_branchless_search<int, std::greater<int>>));
+    ASSERT_FALSE((fox::detail::use_branchless_search<
+                  std::string,
+                  std::less<std::string>>));
+}
+
+TEST(FlatMapSearch, ContiguousKeys)
+{
+    for (const size_t size : {0, 1, 3, 17, 64, 100, 1000}) {
+        check_lower_bound<int32_t>(size);
+        check_lower_bound<uint32_t>(size);
+        check_lower_bound<int64_t>(size);
+        check_lower_bound<uint64_t>(size);
+        check_lower_bound<double>(size);
+    }
+}
+
+TEST(FlatMapSearch, SignedAndUnsignedExtremes)
+{
+    const std::vector<int64_t> signedKeys = {INT64_MIN, -1, 0, 1, INT64_MAX};
+    ASSERT_EQ(
+            fox::detail::lower_bound_index(signedKeys.data(), 5, int64_t{0}),
+            2);
+
+    const std::vector<uint64_t> unsignedKeys
+            = {0, 1, UINT64_MAX - 1, UINT64_MAX};
+    ASSERT_EQ(
+            fox::detail::lower_bound_index(
+                    unsignedKeys.data(), 4, UINT64_MAX),
+            3);
+}
+
+TEST(FlatMapSearch, FlatMapUsesBranchlessPath)
+{
+    fox::FlatMap<int64_t, int> mymap;
+    for (int i = 0; i < 1000; ++i) {
+        mymap.insert(static_cast<int64_t>(i) * 3, i);
+    }
+
+    for (int i = 0; i < 3000; ++i) {
+        ASSERT_EQ(mymap.contains(i), i % 3 == 0);
+    }
+    ASSERT_EQ(mymap.at(2997), 999);
+}
@@ -0,0 +1,113 @@
+#include <flatmap_soa.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+TEST(FlatMapSoA, SimpleCheck)
+{
+    fox::FlatMapSoA<std::string, int> mymap;
+    mymap.insert("foo", 100);
+    mymap["bar"] = 200;
+    mymap["bee"] = 300;
+
+    ASSERT_EQ(mymap.at("foo"), 100);
+    ASSERT_EQ(mymap.at("bar"), 200);
+    ASSERT_EQ(mymap.at("bee"), 300);
+    ASSERT_FALSE(mymap.insert("foo", 400).second);
+    ASSERT_EQ(mymap.at("foo"), 100);
+    ASSERT_THROW(mymap.at("baz"), std::out_of_range);
+}
+
+TEST(FlatMapSoA, SeparateContainers)
+{
+    const fox::FlatMapSoA<int, std::string> mymap
+            = {{3, "c"}, {1, "a"}, {2, "b"}, {1, "z"}};
+
+    ASSERT_EQ(mymap.keys(), (std::vector<int>{1, 2, 3}));
+    ASSERT_EQ(mymap.values(), (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(FlatMapSoA, Iteration)
+{
+    fox::FlatMapSoA<int, int> mymap = {{2, 200}, {1, 100}, {3, 300}};
+    for (auto pair : mymap) {
+        pair.second += pair.first;
+    }
+
+    int expected = 1;
+    for (auto iter = mymap.begin(); iter != mymap.end(); ++iter) {
+        ASSERT_EQ(iter->first, expected);
+        ASSERT_EQ(iter->second, expected * 101);
+        ++expected;
+    }
+    ASSERT_EQ(mymap.end() - mymap.begin(), 3);
+}
+
+TEST(FlatMapSoA, EraseAndFind)
+{
+    fox::FlatMapSoA<std::string, int> mymap
+            = {{"foo", 100}, {"bar", 200}, {"bee", 300}};
+
+    ASSERT_TRUE(mymap.erase("bar"));
+    ASSERT_FALSE(mymap.erase("bar"));
+    ASSERT_EQ(mymap.find("bar"), mymap.end());
+    ASSERT_EQ((*mymap.find("bee")).second, 300);
+    ASSERT_TRUE(mymap.contains("foo"));
+    ASSERT_EQ(mymap.size(), 2);
+}
+
+TEST(FlatMapSoA, ExtractReplace)
+{
+    fox::FlatMapSoA<int, std::string> mymap = {{1, "a"}, {2, "b"}};
+    const std::string* valuesData = mymap.values().data();
+
+    auto containers = std::move(mymap).extract();
+
+    ASSERT_TRUE(mymap.empty());
+    ASSERT_EQ(containers.keys, (std::vector<int>{1, 2}));
+    ASSERT_EQ(containers.values.data(), valuesData);
+
+    containers.keys.push_back(3);
+    containers.values.emplace_back("c");
+    const int* keysData = containers.keys.data();
+    mymap.replace(std::move(containers.keys), std::move(containers.values));
+
+    ASSERT_EQ(mymap.size(), 3);
+    ASSERT_EQ(mymap.keys().data(), keysData);
+    ASSERT_EQ(mymap.at(3), "c");
+    ASSERT_THROW(
+            mymap.replace(std::vector<int>{1}, std::vector<std::string>{}),
+            std::invalid_argument);
+}
+
+TEST(FlatMapSoA, TransparentLookup)
+{
+    fox::FlatMapSoA<std::string, int, std::less<>> mymap
+            = {{"foo", 100}, {"bar", 200}};
+
+    ASSERT_EQ(mymap.at("foo"), 100);
+    ASSERT_EQ(mymap.count(std::string_view("bar")), 1);
+    ASSERT_FALSE(mymap.contains("bee"));
+    ASSERT_TRUE(mymap.erase(std::string_view("foo")));
+    ASSERT_EQ(mymap.size(), 1);
+}
+
+TEST(FlatMapSoA, TryEmplaceMoveOnly)
+{
+    fox::FlatMapSoA<std::string, std::unique_ptr<int>> mymap;
+    auto result = mymap.try_emplace("foo", std::make_unique<int>(100));
+    mymap.insert_or_assign("bar", std::make_unique<int>(200));
+    mymap.insert_or_assign("bar", std::make_unique<int>(300));
+
+    ASSERT_TRUE(result.second);
+    ASSERT_EQ(*mymap.at("foo"), 100);
+    ASSERT_EQ(*mymap.at("bar"), 300);
+    ASSERT_FALSE(mymap.try_emplace("foo", nullptr).second);
+    ASSERT_EQ(mymap["bee"], nullptr);
+}
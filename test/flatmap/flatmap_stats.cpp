@@ -0,0 +1,112 @@
+#include <flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    template <class Key, class T>
+    using CountedMap = fox::FlatMap<
+            Key,
+            T,
+            std::less<Key>,
+            std::allocator<std::pair<const Key, T>>,
+            fox::FlatMapStats>;
+
+} // namespace
+
+TEST(FlatMapStats, DisabledByDefault)
+{
+    static_assert(
+            sizeof(fox::FlatMap<int, int>)
+            < sizeof(CountedMap<int, int>));
+
+    fox::FlatMap<int, int> mymap = {{1, 1}, {2, 2}};
+    mymap.find(1);
+    const auto snapshot = mymap.stats().snapshot();
+    ASSERT_EQ(snapshot.lookups, 0);
+    ASSERT_EQ(snapshot.reallocations, 0);
+}
+
+TEST(FlatMapStats, Lookups)
+{
+    CountedMap<std::string, int> mymap;
+    for (int key = 0; key < 100; ++key) {
+        mymap.insert(std::to_string(key), key);
+    }
+    mymap.stats().reset();
+
+    mymap.find("1");
+    mymap.contains("x");
+    mymap.count("50");
+    ASSERT_THROW(mymap.at("y"), std::out_of_range);
+
+    const auto snapshot = mymap.stats().snapshot();
+    ASSERT_EQ(snapshot.lookups, 4);
+    ASSERT_EQ(snapshot.hits, 2);
+    ASSERT_EQ(snapshot.misses, 2);
+    ASSERT_EQ(snapshot.searches, 4);
+    // Binary search over 100 keys.
+    ASSERT_GE(snapshot.comparisons_per_search(), 6.0);
+    ASSERT_LE(snapshot.comparisons_per_search(), 8.0);
+    ASSERT_EQ(snapshot.reallocations, 0);
+}
+
+TEST(FlatMapStats, MovesAndAllocations)
+{
+    CountedMap<int, int> mymap;
+    mymap.insert(1, 1);
+    mymap.insert(2, 2);
+    mymap.insert(3, 3);
+    // Capacities 1, 2 and 4; growing moved 1 and then 2 elements.
+    auto snapshot = mymap.stats().snapshot();
+    ASSERT_EQ(snapshot.reallocations, 3);
+    ASSERT_EQ(snapshot.peakCapacity, 4);
+    ASSERT_EQ(snapshot.bytesAllocated, 7 * sizeof(std::pair<const int, int>));
+    ASSERT_EQ(snapshot.movedElements, 3);
+
+    // Inserting at the front shifts all three.
+    mymap.insert(0, 0);
+    ASSERT_EQ(mymap.stats().snapshot().movedElements, 6);
+
+    // Erasing the front shifts the other three back.
+    mymap.erase(0);
+    ASSERT_EQ(mymap.stats().snapshot().movedElements, 9);
+
+    mymap.erase_if([](const auto& pair) { return pair.first == 1; });
+    ASSERT_EQ(mymap.stats().snapshot().movedElements, 11);
+}
+
+TEST(FlatMapStats, ConcurrentReaders)
+{
+    CountedMap<int, int> mymap;
+    for (int key = 0; key < 1000; ++key) {
+        mymap.insert(key, key);
+    }
+    mymap.stats().reset();
+
+    const auto& shared = mymap;
+    std::vector<std::thread> readers;
+    for (int thread = 0; thread < 4; ++thread) {
+        readers.emplace_back([&shared] {
+            for (int key = 0; key < 2000; ++key) {
+                shared.find(key);
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    const auto snapshot = shared.stats().snapshot();
+    ASSERT_EQ(snapshot.lookups, 8000);
+    ASSERT_EQ(snapshot.hits, 4000);
+    ASSERT_EQ(snapshot.misses, 4000);
+}
@@ -0,0 +1,157 @@
+#include <flatmap.hpp>
+#include <flatmap_fd.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Record {
+        std::string name;
+        int id = 0;
+    };
+
+    using StringMap = fox::FlatMap<std::string, std::vector<int>>;
+
+    StringMap make_map(int count)
+    {
+        StringMap map;
+        for (int i = 0; i < count; ++i) {
+            map.insert(
+                    "key" + std::to_string(i),
+                    std::vector<int>(static_cast<size_t>(i % 7), i));
+        }
+        return map;
+    }
+
+    void expect_equal(const StringMap& lhs, const StringMap& rhs)
+    {
+        ASSERT_EQ(lhs.size(), rhs.size());
+        auto left = lhs.begin();
+        for (const auto& [key, value] : rhs) {
+            ASSERT_EQ(left->first, key);
+            ASSERT_EQ(left->second, value);
+            ++left;
+        }
+    }
+
+} // namespace
+
+template <>
+struct fox::codec<Record> {
+    static void encode(BinaryWriter& writer, const Record& record)
+    {
+        codec<std::string>::encode(writer, record.name);
+        writer.write_varint(static_cast<uint64_t>(record.id));
+    }
+
+    static Record decode(BinaryReader& reader)
+    {
+        Record record;
+        record.name = codec<std::string>::decode(reader);
+        record.id = static_cast<int>(reader.read_varint());
+        return record;
+    }
+};
+
+TEST(FlatMapStream, RoundTrip)
+{
+    for (const bool checksum : {true, false}) {
+        for (const int size : {0, 1, 1000}) {
+            const auto mymap = make_map(size);
+            std::stringstream stream;
+            mymap.serialize(stream, {checksum, 256});
+
+            const auto loaded = StringMap::deserialize(stream);
+            expect_equal(loaded, mymap);
+            ASSERT_EQ(loaded.capacity(), loaded.size());
+        }
+    }
+}
+
+TEST(FlatMapStream, CustomCodec)
+{
+    fox::FlatMap<int, Record> mymap;
+    mymap.insert(2, Record{"two", 2});
+    mymap.insert(1, Record{std::string(1000, 'x'), 1});
+
+    std::stringstream stream;
+    mymap.serialize(stream);
+    const auto loaded = fox::FlatMap<int, Record>::deserialize(stream);
+
+    ASSERT_EQ(loaded.size(), 2);
+    ASSERT_EQ(loaded.at(1).name, std::string(1000, 'x'));
+    ASSERT_EQ(loaded.at(2).name, "two");
+    ASSERT_EQ(loaded.at(2).id, 2);
+}
+
+TEST(FlatMapStream, RejectsDamagedInput)
+{
+    std::stringstream stream;
+    make_map(100).serialize(stream);
+    const std::string image = stream.str();
+
+    std::string flipped = image;
+    flipped[image.size() / 2] ^= 0x20;
+    std::istringstream corrupt(flipped);
+    ASSERT_THROW(StringMap::deserialize(corrupt), std::runtime_error);
+
+    std::istringstream truncated(image.substr(0, image.size() - 5));
+    ASSERT_THROW(StringMap::deserialize(truncated), std::runtime_error);
+
+    std::istringstream garbage(std::string(64, 'x'));
+    ASSERT_THROW(StringMap::deserialize(garbage), std::runtime_error);
+
+    std::istringstream wrongType(image);
+    ASSERT_THROW(
+            (fox::FlatMap<int, int>::deserialize(wrongType)),
+            std::runtime_error);
+}
+
+TEST(FlatMapStream, RejectsCorruptSizes)
+{
+    std::stringstream stream;
+    make_map(100).serialize(stream);
+    const std::string image = stream.str();
+
+    // The header's element count sits after the magic, version and flags;
+    // the first block's element count and payload size follow it.
+    for (const size_t offset : {16, 24, 28}) {
+        std::string corrupt = image;
+        corrupt.replace(offset, 4, "\xff\xff\xff\x7f");
+        std::istringstream in(corrupt);
+        ASSERT_THROW(StringMap::deserialize(in), std::runtime_error);
+    }
+
+    std::string hugeCount = image;
+    hugeCount.replace(16, 8, std::string(8, '\xff'));
+    std::istringstream in(hugeCount);
+    ASSERT_THROW(StringMap::deserialize(in), std::runtime_error);
+}
+
+TEST(FlatMapStream, Crc32cKnownAnswer)
+{
+    ASSERT_EQ(fox::detail::crc32c("123456789", 9), 0xE3069283U);
+    ASSERT_EQ(fox::detail::crc32c("", 0), 0U);
+    const std::string zeros(32, '\0');
+    ASSERT_EQ(fox::detail::crc32c(zeros.data(), zeros.size()), 0x8A9136AAU);
+}
+
+TEST(FlatMapStream, FileDescriptor)
+{
+    const auto mymap = make_map(500);
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    fox::serialize_fd(mymap, fileno(file));
+    std::rewind(file);
+    const auto loaded = fox::deserialize_fd<StringMap>(fileno(file));
+    std::fclose(file);
+
+    expect_equal(loaded, mymap);
+}
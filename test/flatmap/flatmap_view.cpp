@@ -0,0 +1,101 @@
+#include <flatmap.hpp>
+#include <flatmap_view.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace {
+
+    struct Point {
+        int32_t x;
+        int32_t y;
+    };
+
+    std::string temp_path(const std::string& name)
+    {
+        return ::testing::TempDir() + "flatmap_view_" + name;
+    }
+
+    fox::FlatMap<int64_t, Point> make_map(int64_t count)
+    {
+        fox::FlatMap<int64_t, Point> map;
+        for (int64_t i = count - 1; i >= 0; --i) {
+            map.insert(i * 3, Point{static_cast<int32_t>(i), -1});
+        }
+        return map;
+    }
+
+} // namespace
+
+TEST(FlatMapView, RoundTrip)
+{
+    const std::string path = temp_path("round_trip");
+    for (const bool withIndex : {true, false}) {
+        for (const int64_t size : {0, 1, 511, 512, 513, 5000}) {
+            make_map(size).save(path, withIndex);
+            const auto view = fox::FlatMapView<int64_t, Point>::open(path);
+
+            ASSERT_EQ(view.size(), static_cast<size_t>(size));
+            ASSERT_EQ(view.has_index(), withIndex && size > 0);
+            for (int64_t key = -1; key <= size * 3; ++key) {
+                const auto iter = view.lower_bound(key);
+                ASSERT_EQ(iter - view.begin(), key < 0 ? 0 : (key + 2) / 3);
+                ASSERT_EQ(view.contains(key), key % 3 == 0 && key < size * 3);
+            }
+        }
+    }
+}
+
+TEST(FlatMapView, IterationAndAt)
+{
+    const std::string path = temp_path("iteration");
+    make_map(1000).save(path);
+    const auto view = fox::FlatMapView<int64_t, Point>::open(path);
+
+    int64_t expected = 0;
+    for (const auto& [key, value] : view) {
+        ASSERT_EQ(key, expected * 3);
+        ASSERT_EQ(value.x, expected);
+        ++expected;
+    }
+    ASSERT_EQ(expected, 1000);
+    ASSERT_EQ(view.rbegin()->first, 2997);
+    ASSERT_EQ(view.at(300).x, 100);
+    ASSERT_EQ(view.find(301), view.end());
+    ASSERT_THROW(view.at(301), std::out_of_range);
+}
+
+TEST(FlatMapView, MoveKeepsMapping)
+{
+    const std::string path = temp_path("move");
+    make_map(10).save(path);
+    auto view = fox::FlatMapView<int64_t, Point>::open(path);
+
+    fox::FlatMapView<int64_t, Point> moved(std::move(view));
+    ASSERT_EQ(moved.at(9).x, 3);
+
+    view = std::move(moved);
+    ASSERT_EQ(view.size(), 10);
+    ASSERT_TRUE(view.contains(27));
+}
+
+TEST(FlatMapView, RejectsForeignFiles)
+{
+    const std::string path = temp_path("foreign");
+    make_map(10).save(path);
+    using WrongValue = fox::FlatMapView<int64_t, int64_t>;
+    ASSERT_THROW(WrongValue::open(path), std::runtime_error);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << std::string(200, 'x');
+    }
+    using View = fox::FlatMapView<int64_t, Point>;
+    ASSERT_THROW(View::open(path), std::runtime_error);
+    ASSERT_THROW(View::open(temp_path("missing")), std::system_error);
+}
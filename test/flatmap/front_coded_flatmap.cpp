@@ -0,0 +1,159 @@
+#include <front_coded_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+TEST(FrontCodedFlatMap, Lookup)
+{
+    fox::FrontCodedFlatMap<int, 2> mymap = {
+            {"https://a.org/x", 1},
+            {"https://a.org/", 2},
+            {"https://b.org/", 3},
+            {"https://a.org/x", 4},
+            {"", 5}};
+
+    ASSERT_EQ(mymap.size(), 4);
+    ASSERT_EQ(mymap.at("https://a.org/x"), 1);
+    ASSERT_EQ(mymap.at("https://a.org/"), 2);
+    ASSERT_EQ(mymap.at(""), 5);
+    ASSERT_TRUE(mymap.contains("https://b.org/"));
+    ASSERT_FALSE(mymap.contains("https://a.org"));
+    ASSERT_EQ(mymap.count("https://c.org/"), 0);
+    ASSERT_THROW(mymap.at("https://a.org/y"), std::out_of_range);
+
+    mymap.at("https://b.org/") = 30;
+    ASSERT_EQ(mymap.find("https://b.org/")->second, 30);
+}
+
+TEST(FrontCodedFlatMap, ConstMapIsReadOnly)
+{
+    using Map = fox::FrontCodedFlatMap<int>;
+    static_assert(std::is_same_v<
+                  decltype(std::declval<const Map&>().at("")),
+                  const int&>);
+    static_assert(std::is_same_v<
+                  decltype(std::declval<const Map&>().find("")->second),
+                  const int&>);
+    static_assert(std::is_same_v<
+                  decltype((*std::declval<const Map&>().begin()).second),
+                  const int&>);
+    static_assert(std::is_same_v<
+                  decltype(std::declval<Map&>().at("")),
+                  int&>);
+
+    Map mymap = {{"a", 1}, {"b", 2}, {"c", 3}};
+    for (auto [key, value] : mymap) {
+        value *= 10;
+    }
+    const Map& view = mymap;
+    Map::const_iterator iter = mymap.find("b");
+    ASSERT_EQ(iter->second, 20);
+    ASSERT_EQ(view.at("c"), 30);
+    ASSERT_EQ(view.lower_bound("b")->first, "b");
+}
+
+TEST(FrontCodedFlatMap, IteratesInOrder)
+{
+    std::vector<std::pair<std::string, int>> pairs;
+    for (int i = 0; i < 100; ++i) {
+        pairs.emplace_back("key/" + std::to_string(i), i);
+    }
+    const fox::FrontCodedFlatMap<int> mymap(pairs.begin(), pairs.end());
+    const std::map<std::string, int> expected(pairs.begin(), pairs.end());
+
+    auto iter = mymap.begin();
+    for (const auto& [key, value] : expected) {
+        ASSERT_NE(iter, mymap.end());
+        ASSERT_EQ(iter->first, key);
+        ASSERT_EQ((*iter).second, value);
+        ++iter;
+    }
+    ASSERT_EQ(iter, mymap.end());
+}
+
+TEST(FrontCodedFlatMap, LowerBound)
+{
+    const fox::FrontCodedFlatMap<int, 3> mymap = {
+            {"ab", 0},
+            {"abc", 1},
+            {"abd", 2},
+            {"abda", 3},
+            {"b", 4},
+            {"ba", 5},
+            {"c", 6}};
+
+    ASSERT_EQ(mymap.lower_bound("")->first, "ab");
+    ASSERT_EQ(mymap.lower_bound("a")->first, "ab");
+    ASSERT_EQ(mymap.lower_bound("abc")->first, "abc");
+    ASSERT_EQ(mymap.lower_bound("abca")->first, "abd");
+    ASSERT_EQ(mymap.lower_bound("abd")->first, "abd");
+    ASSERT_EQ(mymap.lower_bound("abdb")->first, "b");
+    ASSERT_EQ(mymap.lower_bound("az")->first, "b");
+    ASSERT_EQ(mymap.lower_bound("bb")->first, "c");
+    ASSERT_EQ(mymap.lower_bound("d"), mymap.end());
+
+    // Bytes compare as unsigned, as they do for std::string.
+    const fox::FrontCodedFlatMap<int> bytes = {{"a\x7f", 0}, {"a\xff", 1}};
+    ASSERT_EQ(bytes.lower_bound("a\x80")->second, 1);
+}
+
+TEST(FrontCodedFlatMap, SortedUniqueFromFlatMap)
+{
+    fox::FlatMap<std::string, int> source;
+    for (int i = 0; i < 1000; ++i) {
+        source.insert("/srv/www/static/img/" + std::to_string(i * 7), i);
+    }
+    const fox::FrontCodedFlatMap<int> mymap(
+            fox::sorted_unique, source.begin(), source.end());
+
+    ASSERT_EQ(mymap.size(), source.size());
+    ASSERT_LT(mymap.bytes(), source.size() * sizeof(source.begin()->first));
+    ASSERT_TRUE(std::equal(
+            source.begin(),
+            source.end(),
+            mymap.begin(),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.first == rhs.first && lhs.second == rhs.second;
+            }));
+}
+
+TEST(FrontCodedFlatMap, MatchesStdMap)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> charDist('a', 'd');
+    std::uniform_int_distribution<int> lengthDist(0, 6);
+    auto randomKey = [&] {
+        std::string key(static_cast<size_t>(lengthDist(rng)), ' ');
+        for (auto& c : key) {
+            c = static_cast<char>(charDist(rng));
+        }
+        return key;
+    };
+
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 2000; ++i) {
+        expected.emplace(randomKey(), i);
+    }
+    const fox::FrontCodedFlatMap<int, 5> mymap(
+            expected.begin(), expected.end());
+
+    for (int i = 0; i < 5000; ++i) {
+        const std::string key = randomKey();
+        const auto wanted = expected.lower_bound(key);
+        const auto found = mymap.lower_bound(key);
+        if (wanted == expected.end()) {
+            ASSERT_EQ(found, mymap.end());
+        } else {
+            ASSERT_EQ(found->first, wanted->first);
+            ASSERT_EQ(found->second, wanted->second);
+        }
+        ASSERT_EQ(mymap.count(key), expected.count(key));
+    }
+}
@@ -0,0 +1,61 @@
+#include <frozen_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+TEST(FrozenFlatMap, Empty)
+{
+    const fox::FrozenFlatMap<int, int> mymap;
+
+    ASSERT_TRUE(mymap.empty());
+    ASSERT_EQ(mymap.find(1), mymap.end());
+    ASSERT_FALSE(mymap.contains(1));
+}
+
+TEST(FrozenFlatMap, Find)
+{
+    for (int size = 1; size < 300; ++size) {
+        fox::FlatMap<int, int> map;
+        for (int i = 0; i < size; ++i) {
+            map.insert(i * 2, i);
+        }
+        const fox::FrozenFlatMap<int, int> mymap(std::move(map));
+
+        for (int key = -1; key <= size * 2; ++key) {
+            const auto iter = mymap.lower_bound(key);
+            const int expected = key < 0 ? 0 : (key + 1) / 2;
+            ASSERT_EQ(iter - mymap.begin(), expected);
+            ASSERT_EQ(
+                    mymap.contains(key),
+                    key >= 0 && key < size * 2 && key % 2 == 0);
+        }
+    }
+}
+
+TEST(FrozenFlatMap, SortedIteration)
+{
+    const fox::FrozenFlatMap<std::string, int> mymap
+            = {{"foo", 100}, {"bar", 200}, {"bee", 300}};
+
+    ASSERT_TRUE(std::is_sorted(
+            mymap.begin(), mymap.end(), [](auto& lhs, auto& rhs) {
+                return lhs.first < rhs.first;
+            }));
+    ASSERT_EQ(mymap.at("bee"), 300);
+    ASSERT_THROW(mymap.at("baz"), std::out_of_range);
+}
+
+TEST(FrozenFlatMap, Thaw)
+{
+    fox::FrozenFlatMap<std::string, int> mymap = {{"foo", 100}};
+    mymap.at("foo") = 200;
+
+    auto map = std::move(mymap).thaw();
+    map.insert("bar", 300);
+
+    ASSERT_EQ(map.at("foo"), 200);
+    ASSERT_EQ(map.size(), 2);
+}
@@ -0,0 +1,340 @@
+#include <packed_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(PackedFlatMap, InsertFind)
+{
+    fox::PackedFlatMap<int, std::string> mymap;
+    ASSERT_TRUE(mymap.insert(3, "c").second);
+    ASSERT_TRUE(mymap.insert(1, "a").second);
+    ASSERT_TRUE(mymap.insert_or_assign(2, "b").second);
+    ASSERT_FALSE(mymap.insert(3, "x").second);
+    mymap[4] = "d";
+
+    ASSERT_EQ(mymap.size(), 4);
+    ASSERT_EQ(mymap.find(2)->second, "b");
+    ASSERT_EQ(mymap.find(5), mymap.end());
+    ASSERT_EQ(mymap.at(3), "c");
+    ASSERT_THROW(mymap.at(0), std::out_of_range);
+
+    std::vector<int> keys;
+    for (const auto& pair : mymap) {
+        keys.push_back(pair.first);
+    }
+    ASSERT_EQ(keys, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(PackedFlatMap, GrowsWithGaps)
+{
+    fox::PackedFlatMap<int, int> mymap;
+    for (int key = 0; key < 10000; ++key) {
+        ASSERT_TRUE(mymap.insert(key * 7 % 10000, key).second);
+    }
+    ASSERT_EQ(mymap.size(), 10000);
+    ASSERT_GT(mymap.capacity(), mymap.size());
+
+    int expected = 0;
+    for (const auto& pair : mymap) {
+        ASSERT_EQ(pair.first, expected++);
+    }
+    ASSERT_EQ(expected, 10000);
+
+    expected = 10000;
+    for (auto iter = mymap.rbegin(); iter != mymap.rend(); ++iter) {
+        ASSERT_EQ(iter->first, --expected);
+    }
+}
+
+TEST(PackedFlatMap, ShrinksOnErase)
+{
+    fox::PackedFlatMap<int, int> mymap;
+    for (int key = 0; key < 4096; ++key) {
+        mymap.insert(key, key);
+    }
+    const size_t grown = mymap.capacity();
+    for (int key = 0; key < 4096; key += 2) {
+        ASSERT_EQ(mymap.erase(key), 1);
+    }
+    ASSERT_EQ(mymap.erase(0), 0);
+    for (int key = 1; key < 4000; key += 2) {
+        ASSERT_EQ(mymap.erase(key), 1);
+    }
+    ASSERT_LT(mymap.capacity(), grown);
+    ASSERT_EQ(mymap.size(), 48);
+    ASSERT_EQ(mymap.begin()->first, 4001);
+    ASSERT_EQ(mymap.lower_bound(4000)->first, 4001);
+    ASSERT_EQ(mymap.lower_bound(5000), mymap.end());
+}
+
+TEST(PackedFlatMap, SortedUniqueAndCopy)
+{
+    std::vector<std::pair<int, std::string>> pairs;
+    for (int key = 0; key < 300; ++key) {
+        pairs.emplace_back(key, std::to_string(key));
+    }
+    fox::PackedFlatMap<int, std::string> mymap(
+            fox::sorted_unique, pairs.begin(), pairs.end());
+    ASSERT_EQ(mymap.size(), 300);
+    ASSERT_EQ(mymap.at(299), "299");
+
+    auto copy = mymap;
+    copy.erase(5);
+    ASSERT_TRUE(mymap.contains(5));
+    ASSERT_FALSE(copy.contains(5));
+
+    mymap = std::move(copy);
+    ASSERT_EQ(mymap.size(), 299);
+    mymap.clear();
+    ASSERT_TRUE(mymap.empty());
+    ASSERT_EQ(mymap.begin(), mymap.end());
+}
+
+TEST(PackedFlatMap, MatchesStdMap)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> keyDist(0, 3000);
+    std::uniform_int_distribution<int> opDist(0, 3);
+
+    fox::PackedFlatMap<int, int> mymap;
+    std::map<int, int> expected;
+    for (int step = 0; step < 40000; ++step) {
+        const int key = keyDist(rng);
+        // Phases of mostly inserts and mostly erases exercise growing and
+        // shrinking.
+        const bool inserting = (step / 10000) % 2 == 0;
+        if (opDist(rng) != 0 ? inserting : !inserting) {
+            ASSERT_EQ(mymap.insert(key, step).second,
+                      expected.emplace(key, step).second);
+        } else {
+            ASSERT_EQ(mymap.erase(key), expected.erase(key));
+        }
+        ASSERT_EQ(mymap.size(), expected.size());
+    }
+    ASSERT_TRUE(std::equal(
+            mymap.begin(), mymap.end(), expected.begin(), expected.end()));
+}
+
+TEST(PackedFlatMap, ThrowingValueLeavesMapIntact)
+{
+    // std::stoi throws for values that are not numbers.
+    struct Parsed {
+        int number;
+        std::string text;
+
+        Parsed(const std::string& value)
+            : number(std::stoi(value)), text(value + std::string(32, '!'))
+        {
+        }
+    };
+
+    fox::PackedFlatMap<int, Parsed> mymap;
+    for (int key = 0; key < 200; key += 2) {
+        mymap.try_emplace(key, std::to_string(key));
+    }
+
+    for (const int key : {-1, 1, 99, 201}) {
+        ASSERT_THROW(mymap.try_emplace(key, "x"), std::invalid_argument);
+    }
+    ASSERT_EQ(mymap.size(), 100);
+    int expected = 0;
+    for (const auto& [key, value] : mymap) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value.number, expected);
+        expected += 2;
+    }
+
+    mymap.try_emplace(99, "99");
+    ASSERT_EQ(mymap.erase(0), 1);
+    ASSERT_EQ(mymap.at(99).number, 99);
+    ASSERT_EQ(mymap.begin()->second.number, 2);
+}
+
+TEST(PackedFlatMap, AssignmentKeepsPmrResource)
+{
+    using Map = fox::PackedFlatMap<
+            int,
+            std::pmr::string,
+            std::less<int>,
+            std::pmr::polymorphic_allocator<
+                    std::pair<const int, std::pmr::string>>>;
+
+    std::pmr::monotonic_buffer_resource arena1;
+    std::pmr::monotonic_buffer_resource arena2;
+    Map mymap1(&arena1);
+    Map mymap2(&arena2);
+    for (int key = 0; key < 100; ++key) {
+        mymap1.insert(key, "a value too long for the small string buffer");
+    }
+
+    mymap2 = mymap1;
+    ASSERT_EQ(mymap2.get_allocator().resource(), &arena2);
+    ASSERT_EQ(mymap2.size(), 100);
+    ASSERT_EQ(mymap2.at(42), mymap1.at(42));
+    ASSERT_EQ(mymap2.at(42).get_allocator().resource(), &arena2);
+
+    Map mymap3(&arena2);
+    mymap3 = std::move(mymap1);
+    ASSERT_EQ(mymap3.get_allocator().resource(), &arena2);
+    ASSERT_EQ(mymap3.size(), 100);
+    ASSERT_EQ(mymap3.at(99), mymap2.at(99));
+}
+
+namespace {
+
+    // Fails every allocation once `budget` reaches zero.
+    template <class T>
+    struct LimitedAllocator {
+        using value_type = T;
+
+        std::shared_ptr<int> budget = std::make_shared<int>(1000);
+
+        LimitedAllocator() = default;
+
+        template <class U>
+        LimitedAllocator(const LimitedAllocator<U>& other)
+            : budget(other.budget)
+        {
+        }
+
+        T* allocate(size_t count)
+        {
+            if (*budget == 0) {
+                throw std::bad_alloc();
+            }
+            --*budget;
+            return std::allocator<T>().allocate(count);
+        }
+
+        void deallocate(T* data, size_t count)
+        {
+            std::allocator<T>().deallocate(data, count);
+        }
+
+        friend bool
+        operator==(const LimitedAllocator& lhs, const LimitedAllocator& rhs)
+        {
+            return lhs.budget == rhs.budget;
+        }
+
+        friend bool
+        operator!=(const LimitedAllocator& lhs, const LimitedAllocator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+    // Moves may throw, so rebalancing copies; every copy after
+    // `copiesLeft` reaches zero throws.
+    struct Fragile {
+        static inline int copiesLeft = -1;
+
+        std::string text;
+
+        Fragile(int value) : text(std::to_string(value))
+        {
+        }
+
+        Fragile(const Fragile& other) : text(other.text)
+        {
+            if (copiesLeft-- == 0) {
+                throw std::runtime_error("copy failed");
+            }
+        }
+
+        Fragile(Fragile&& other) noexcept(false)
+            : text(std::move(other.text))
+        {
+        }
+
+        Fragile& operator=(const Fragile& other) = default;
+        Fragile& operator=(Fragile&& other) = default;
+    };
+
+    template <class Map>
+    void expect_keys(const Map& map, const std::vector<int>& keys)
+    {
+        ASSERT_EQ(map.size(), keys.size());
+        ASSERT_TRUE(std::equal(
+                keys.begin(),
+                keys.end(),
+                map.begin(),
+                map.end(),
+                [](int key, const auto& pair) { return key == pair.first; }));
+    }
+
+} // namespace
+
+TEST(PackedFlatMap, FailedResizeLeavesMapIntact)
+{
+    using Alloc = LimitedAllocator<std::pair<const int, int>>;
+    const Alloc alloc;
+    fox::PackedFlatMap<int, int, std::less<int>, Alloc> mymap(alloc);
+    std::vector<int> keys;
+    for (int key = 0; key < 32; ++key) {
+        mymap.insert(key, key);
+        keys.push_back(key);
+    }
+
+    // The next resize cannot get its slots.
+    *alloc.budget = 0;
+    bool failed = false;
+    for (int key = 32; key < 1000 && !failed; ++key) {
+        try {
+            mymap.insert(key, key);
+            keys.push_back(key);
+        } catch (const std::bad_alloc&) {
+            failed = true;
+        }
+    }
+    ASSERT_TRUE(failed);
+    expect_keys(mymap, keys);
+
+    *alloc.budget = 1000;
+    mymap.insert(5000, 5000);
+    keys.push_back(5000);
+    expect_keys(mymap, keys);
+}
+
+TEST(PackedFlatMap, ThrowingRelocationLeavesMapIntact)
+{
+    Fragile::copiesLeft = -1;
+    fox::PackedFlatMap<int, Fragile> mymap;
+    std::map<int, std::string> expected;
+    std::mt19937 rng(5);
+    for (int step = 0; step < 3000; ++step) {
+        const int key = static_cast<int>(rng() % 2000);
+        // Now and then, fail one of the copies a rebalance makes.
+        Fragile::copiesLeft = step % 7 == 0 ? static_cast<int>(rng() % 64)
+                                            : -1;
+        try {
+            if (step % 5 == 4) {
+                mymap.erase(key);
+                expected.erase(key);
+            } else if (mymap.try_emplace(key, key).second) {
+                expected.emplace(key, std::to_string(key));
+            }
+        } catch (const std::runtime_error&) {
+        }
+        Fragile::copiesLeft = -1;
+        ASSERT_EQ(mymap.size(), expected.size());
+    }
+    ASSERT_TRUE(std::equal(
+            mymap.begin(),
+            mymap.end(),
+            expected.begin(),
+            expected.end(),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.first == rhs.first && lhs.second.text == rhs.second;
+            }));
+}
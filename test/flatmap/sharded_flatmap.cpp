@@ -0,0 +1,133 @@
+#include <sharded_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    std::vector<int> make_sample(int count)
+    {
+        std::vector<int> sample;
+        for (int i = 0; i < count; ++i) {
+            sample.push_back(i * 10);
+        }
+        return sample;
+    }
+
+} // namespace
+
+TEST(ShardedFlatMap, SampledBoundaries)
+{
+    const auto sample = make_sample(100);
+    fox::ShardedFlatMap<int, int> mymap(4, sample.begin(), sample.end());
+
+    ASSERT_EQ(mymap.shard_count(), 4);
+    for (int key = 999; key >= -5; key -= 7) {
+        ASSERT_TRUE(mymap.insert(key, key * 2));
+    }
+    ASSERT_FALSE(mymap.insert(999, 0));
+    ASSERT_TRUE(mymap.contains(-2));
+    ASSERT_EQ(mymap.get(992), 1984);
+    ASSERT_FALSE(mymap.get(1000).has_value());
+    ASSERT_EQ(mymap.erase(992), 1);
+    ASSERT_FALSE(mymap.contains(992));
+}
+
+TEST(ShardedFlatMap, OrderedIteration)
+{
+    const auto sample = make_sample(64);
+    fox::ShardedFlatMap<int, int> mymap(8, sample.begin(), sample.end());
+    std::vector<int> expected;
+    for (int key = 700; key >= -100; key -= 3) {
+        mymap.insert(key, 0);
+        expected.push_back(key);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<int> keys;
+    for (const auto& pair : mymap) {
+        keys.push_back(pair.first);
+    }
+    ASSERT_EQ(keys, expected);
+
+    keys.clear();
+    mymap.for_each([&](const auto& pair) { keys.push_back(pair.first); });
+    ASSERT_EQ(keys, expected);
+}
+
+TEST(ShardedFlatMap, RangeQuery)
+{
+    const auto sample = make_sample(64);
+    fox::ShardedFlatMap<int, int> mymap(8, sample.begin(), sample.end());
+    for (int key = 0; key < 640; ++key) {
+        mymap.insert(key, key);
+    }
+
+    std::vector<int> keys;
+    mymap.for_each_range(
+            95, 405, [&](const auto& pair) { keys.push_back(pair.first); });
+    ASSERT_EQ(keys.size(), 310);
+    ASSERT_EQ(keys.front(), 95);
+    ASSERT_EQ(keys.back(), 404);
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+    keys.clear();
+    mymap.for_each_range(
+            405, 95, [&](const auto& pair) { keys.push_back(pair.first); });
+    ASSERT_TRUE(keys.empty());
+}
+
+TEST(ShardedFlatMap, Rebalance)
+{
+    fox::ShardedFlatMap<int, int> mymap;
+    ASSERT_EQ(mymap.shard_count(), 1);
+    for (int key = 0; key < 1000; ++key) {
+        mymap.insert(key, -key);
+    }
+
+    mymap.rebalance(10);
+    ASSERT_EQ(mymap.shard_count(), 10);
+    ASSERT_EQ(mymap.size(), 1000);
+    int expected = 0;
+    for (const auto& [key, value] : mymap) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value, -expected);
+        ++expected;
+    }
+
+    fox::ShardedFlatMap<int, int> small;
+    small.insert(1, 1);
+    small.rebalance(10);
+    ASSERT_EQ(small.shard_count(), 1);
+    ASSERT_EQ(small.get(1), 1);
+}
+
+TEST(ShardedFlatMap, ParallelInsert)
+{
+    const auto sample = make_sample(100);
+    fox::ShardedFlatMap<int, int> mymap(8, sample.begin(), sample.end());
+
+    std::vector<std::thread> writers;
+    for (int thread = 0; thread < 4; ++thread) {
+        writers.emplace_back([&mymap, thread] {
+            for (int key = thread; key < 1000; key += 4) {
+                mymap.insert(key, thread);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    ASSERT_EQ(mymap.size(), 1000);
+    int expected = 0;
+    for (const auto& [key, value] : mymap) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value, expected % 4);
+        ++expected;
+    }
+}
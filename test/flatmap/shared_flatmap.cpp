@@ -0,0 +1,139 @@
+#include <shared_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+TEST(SharedFlatMap, CopiesShareStorage)
+{
+    const fox::SharedFlatMap<std::string, int> config = {{"a", 1}, {"b", 2}};
+    ASSERT_FALSE(config.is_shared());
+
+    auto copy = config;
+    ASSERT_TRUE(config.is_shared());
+    ASSERT_TRUE(copy.is_shared());
+    ASSERT_EQ(&*copy.begin(), &*config.begin());
+
+    // Lookups on a non-const copy do not detach it.
+    ASSERT_EQ(copy.at("a"), 1);
+    ASSERT_EQ(copy.find("b")->second, 2);
+    ASSERT_EQ(copy.find("c"), copy.end());
+    ASSERT_EQ(copy.count("c"), 0);
+    ASSERT_THROW(copy.at("c"), std::out_of_range);
+    ASSERT_TRUE(copy.is_shared());
+}
+
+TEST(SharedFlatMap, WritesDetach)
+{
+    const fox::SharedFlatMap<int, int> original = {{1, 10}, {2, 20}};
+    auto copy = original;
+
+    copy[1] = 11;
+    ASSERT_FALSE(copy.is_shared());
+    ASSERT_FALSE(original.is_shared());
+    copy.insert(3, 30);
+    copy.erase(2);
+
+    ASSERT_EQ(original.size(), 2);
+    ASSERT_EQ(original.at(1), 10);
+    ASSERT_EQ(original.at(2), 20);
+    ASSERT_EQ(copy.size(), 2);
+    ASSERT_EQ(copy.at(1), 11);
+    ASSERT_EQ(copy.at(3), 30);
+}
+
+TEST(SharedFlatMap, CheapWritesKeepSharing)
+{
+    const fox::SharedFlatMap<int, int> original = {{1, 10}};
+    auto copy = original;
+
+    ASSERT_FALSE(copy.erase(5));
+    ASSERT_TRUE(copy.is_shared());
+
+    copy.clear();
+    ASSERT_TRUE(copy.empty());
+    ASSERT_EQ(original.size(), 1);
+
+    copy.insert(2, 20);
+    ASSERT_EQ(copy.size(), 1);
+    ASSERT_FALSE(original.contains(2));
+}
+
+TEST(SharedFlatMap, Iteration)
+{
+    const fox::SharedFlatMap<int, int> original = {{1, 1}, {2, 2}};
+    auto copy = original;
+
+    int sum = 0;
+    for (const auto& pair : copy) {
+        sum += pair.second;
+    }
+    ASSERT_EQ(sum, 3);
+    ASSERT_EQ(copy.crbegin()->first, 2);
+    ASSERT_TRUE(copy.is_shared());
+
+    // Writing through iterators goes through edit(), which detaches.
+    for (auto& pair : copy.edit()) {
+        pair.second *= 10;
+    }
+    ASSERT_FALSE(copy.is_shared());
+    ASSERT_EQ(copy.at(2), 20);
+    ASSERT_EQ(original.at(2), 2);
+}
+
+TEST(SharedFlatMap, ConcurrentCopies)
+{
+    fox::SharedFlatMap<int, int> config;
+    for (int key = 0; key < 1000; ++key) {
+        config.insert(key, key);
+    }
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&config, id] {
+            for (int request = 0; request < 200; ++request) {
+                auto local = std::as_const(config);
+                ASSERT_EQ(local.at(request), request);
+                if (request % 10 == id) {
+                    local[request] = -1;
+                    ASSERT_EQ(local.at(request), -1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(config.at(42), 42);
+}
+
+TEST(SharedFlatMap, LookupsAreReadOnly)
+{
+    using Map = fox::SharedFlatMap<std::string, int, std::less<>>;
+    static_assert(std::is_same_v<
+                  decltype(std::declval<Map&>().find("a")),
+                  Map::const_iterator>);
+    static_assert(std::is_same_v<
+                  decltype(std::declval<Map&>().equal_range("a").first),
+                  Map::const_iterator>);
+
+    const Map original = {{"a", 1}, {"b", 2}};
+    auto copy = original;
+    const std::string_view key = "b";
+    ASSERT_EQ(copy.find(key)->second, 2);
+    ASSERT_EQ(copy.equal_range(key).first, copy.lower_bound(key));
+    ASSERT_EQ(copy.at(key), 2);
+    ASSERT_TRUE(copy.contains(key));
+    ASSERT_TRUE(copy.is_shared());
+
+    copy.edit().find(key)->second = 20;
+    ASSERT_EQ(copy.at(key), 20);
+    ASSERT_EQ(original.at(key), 2);
+}
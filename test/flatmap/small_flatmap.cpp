@@ -0,0 +1,179 @@
+#include <small_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(SmallFlatMap, StaysInline)
+{
+    fox::SmallFlatMap<int, std::string, 4> mymap;
+    mymap.insert(3, "c");
+    mymap.insert(1, "a");
+    mymap[4] = "d";
+    mymap.insert_or_assign(2, "b");
+
+    ASSERT_TRUE(mymap.is_inline());
+    ASSERT_EQ(mymap.size(), 4);
+    ASSERT_FALSE(mymap.insert(3, "x").second);
+    ASSERT_EQ(mymap.at(3), "c");
+    ASSERT_THROW(mymap.at(5), std::out_of_range);
+
+    std::vector<int> keys;
+    for (const auto& pair : mymap) {
+        keys.push_back(pair.first);
+    }
+    ASSERT_EQ(keys, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(SmallFlatMap, SpillsToHeap)
+{
+    fox::SmallFlatMap<int, int, 4> mymap;
+    for (int key = 10; key > 0; --key) {
+        ASSERT_TRUE(mymap.insert(key, key * 10).second);
+        ASSERT_EQ(mymap.is_inline(), mymap.size() <= 4);
+    }
+
+    int expected = 1;
+    for (const auto& [key, value] : mymap) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value, expected * 10);
+        ++expected;
+    }
+    ASSERT_EQ(mymap.erase(5), 1);
+    ASSERT_FALSE(mymap.contains(5));
+
+    mymap.clear();
+    ASSERT_TRUE(mymap.empty());
+    ASSERT_TRUE(mymap.is_inline());
+}
+
+TEST(SmallFlatMap, Erase)
+{
+    fox::SmallFlatMap<std::string, int, 8> mymap = {
+            {"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}};
+
+    auto next = mymap.erase(mymap.find("b"));
+    ASSERT_EQ(next->first, "c");
+    ASSERT_EQ(mymap.erase("d"), 1);
+    ASSERT_EQ(mymap.erase("z"), 0);
+    ASSERT_EQ(mymap.size(), 2);
+    ASSERT_EQ(mymap.begin()->first, "a");
+    ASSERT_EQ(mymap.rbegin()->first, "c");
+}
+
+TEST(SmallFlatMap, CopyAndMove)
+{
+    fox::SmallFlatMap<int, std::string, 2> small = {{1, "a"}, {2, "b"}};
+    fox::SmallFlatMap<int, std::string, 2> large = {
+            {1, "a"}, {2, "b"}, {3, "c"}};
+
+    auto smallCopy = small;
+    auto largeCopy = large;
+    ASSERT_TRUE(smallCopy.is_inline());
+    ASSERT_FALSE(largeCopy.is_inline());
+    ASSERT_EQ(smallCopy.at(2), "b");
+    ASSERT_EQ(largeCopy.at(3), "c");
+
+    auto smallMoved = std::move(small);
+    ASSERT_EQ(smallMoved.at(1), "a");
+    ASSERT_TRUE(small.empty());
+
+    largeCopy = std::move(smallMoved);
+    ASSERT_TRUE(largeCopy.is_inline());
+    ASSERT_EQ(largeCopy.size(), 2);
+
+    smallCopy = large;
+    ASSERT_FALSE(smallCopy.is_inline());
+    ASSERT_EQ(smallCopy.size(), 3);
+}
+
+TEST(SmallFlatMap, MoveOnlyValues)
+{
+    fox::SmallFlatMap<int, std::unique_ptr<int>, 2> mymap;
+    for (int key = 0; key < 5; ++key) {
+        mymap.try_emplace(key, std::make_unique<int>(key));
+    }
+    ASSERT_EQ(*mymap.at(4), 4);
+
+    auto moved = std::move(mymap);
+    ASSERT_EQ(*moved.at(0), 0);
+}
+
+namespace {
+
+    // Owns heap memory, so a double destroy shows up under ASan.
+    struct PickyValue {
+        std::string text;
+
+        PickyValue(int value)
+            : text(std::to_string(value) + std::string(32, '!'))
+        {
+            if (value < 0) {
+                throw std::invalid_argument("negative value");
+            }
+        }
+    };
+
+    // Copies throw once `copiesLeft` runs out.
+    struct FragileValue {
+        static inline int copiesLeft = 0;
+
+        std::string text = std::string(32, '!');
+
+        FragileValue() = default;
+
+        FragileValue(const FragileValue& other) : text(other.text)
+        {
+            if (copiesLeft-- == 0) {
+                throw std::runtime_error("copy failed");
+            }
+        }
+
+        FragileValue& operator=(const FragileValue&) = default;
+    };
+
+} // namespace
+
+TEST(SmallFlatMap, ThrowingValueLeavesMapIntact)
+{
+    fox::SmallFlatMap<int, PickyValue, 4> mymap;
+    mymap.try_emplace(1, 1);
+    mymap.try_emplace(3, 3);
+
+    ASSERT_THROW(mymap.try_emplace(0, -1), std::invalid_argument);
+    ASSERT_THROW(mymap.try_emplace(2, -1), std::invalid_argument);
+    ASSERT_THROW(mymap.try_emplace(4, -1), std::invalid_argument);
+    ASSERT_EQ(mymap.size(), 2);
+    ASSERT_EQ(mymap.begin()->first, 1);
+    ASSERT_EQ(mymap.at(3).text.substr(0, 1), "3");
+
+    mymap.try_emplace(2, 2);
+    mymap.erase(1);
+    ASSERT_EQ(mymap.size(), 2);
+    ASSERT_EQ(mymap.begin()->first, 2);
+    ASSERT_EQ(mymap.at(2).text.substr(0, 1), "2");
+}
+
+TEST(SmallFlatMap, ThrowingConstructorsDoNotLeak)
+{
+    using Map = fox::SmallFlatMap<int, FragileValue, 4>;
+    const FragileValue value;
+    FragileValue::copiesLeft = 100;
+    const std::initializer_list<Map::value_type> list = {
+            {1, value}, {2, value}, {3, value}};
+    Map mymap = list;
+
+    FragileValue::copiesLeft = 1;
+    ASSERT_THROW(Map{list}, std::runtime_error);
+    FragileValue::copiesLeft = 2;
+    ASSERT_THROW(Map copy(mymap), std::runtime_error);
+    // FragileValue has no move constructor, so moving copies it.
+    FragileValue::copiesLeft = 1;
+    ASSERT_THROW(Map moved(std::move(mymap)), std::runtime_error);
+    ASSERT_EQ(mymap.size(), 3);
+}
@@ -0,0 +1,89 @@
+#include <static_flatmap.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    enum class Opcode { Load, Store, Add, Jump };
+
+    constexpr auto keywords = fox::make_static_flat_map<std::string_view, int>(
+            {{"while", 4}, {"if", 1}, {"return", 3}, {"else", 2}, {"for", 0}});
+
+    constexpr auto opcodeNames
+            = fox::make_static_flat_map<Opcode, std::string_view>(
+                    {{Opcode::Jump, "jmp"},
+                     {Opcode::Load, "ld"},
+                     {Opcode::Add, "add"},
+                     {Opcode::Store, "st"}});
+
+    // Lookups are constant expressions too.
+    static_assert(keywords.size() == 5);
+    static_assert(keywords.at("return") == 3);
+    static_assert(keywords.contains("for"));
+    static_assert(!keywords.contains("goto"));
+    static_assert(keywords.begin()->first == "else");
+    static_assert(opcodeNames.at(Opcode::Add) == "add");
+
+} // namespace
+
+TEST(StaticFlatMap, Lookup)
+{
+    ASSERT_EQ(keywords.find("if")->second, 1);
+    ASSERT_EQ(keywords.find("iff"), keywords.end());
+    ASSERT_EQ(keywords.count("while"), 1);
+    ASSERT_THROW(keywords.at("do"), std::out_of_range);
+    ASSERT_EQ(opcodeNames.at(Opcode::Jump), "jmp");
+
+    ASSERT_EQ(keywords.lower_bound("a")->first, "else");
+    ASSERT_EQ(keywords.lower_bound("g")->first, "if");
+    ASSERT_EQ(keywords.lower_bound("x"), keywords.end());
+}
+
+TEST(StaticFlatMap, IteratesInOrder)
+{
+    std::vector<std::string_view> names;
+    for (const auto& [name, value] : keywords) {
+        names.push_back(name);
+    }
+    ASSERT_EQ(names,
+              (std::vector<std::string_view>{
+                      "else", "for", "if", "return", "while"}));
+    ASSERT_EQ(keywords.rbegin()->first, "while");
+}
+
+TEST(StaticFlatMap, CustomCompare)
+{
+    constexpr auto descending
+            = fox::make_static_flat_map<int, char, std::greater<int>>(
+                    {{1, 'a'}, {3, 'c'}, {2, 'b'}});
+    static_assert(descending.begin()->first == 3);
+    ASSERT_EQ(descending.at(2), 'b');
+    ASSERT_EQ(descending.lower_bound(5)->first, 3);
+    ASSERT_EQ(descending.lower_bound(0), descending.end());
+}
+
+TEST(StaticFlatMap, RejectsDuplicates)
+{
+    // The same call in a constexpr initializer fails to compile.
+    ASSERT_THROW(
+            (fox::make_static_flat_map<int, int>({{1, 1}, {2, 2}, {1, 3}})),
+            std::invalid_argument);
+}
+
+TEST(StaticFlatMap, EveryKeyFound)
+{
+    constexpr auto squares = fox::make_static_flat_map<int, int>(
+            {{9, 81}, {2, 4}, {7, 49}, {0, 0}, {5, 25}, {3, 9}, {8, 64},
+             {1, 1}, {6, 36}, {4, 16}});
+    for (int key = -1; key <= 10; ++key) {
+        ASSERT_EQ(squares.contains(key), key >= 0 && key < 10) << key;
+        if (key >= 0 && key < 10) {
+            ASSERT_EQ(squares.at(key), key * key);
+        }
+    }
+}